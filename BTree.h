@@ -0,0 +1,702 @@
+/**
+-----------------------------------------------------------------------------------
+Laboratoire : 09
+\file       BTree.h
+\author     Loïc Dessaules, Doran Kayoumi, Gabrielle Thurnherr
+\date       16/10/2026
+\brief      B-arbre pour les clés arithmétiques : plusieurs clés par noeud,
+            comparées en une fois avec les instructions SIMD disponibles
+Compilateur MinGW-gcc 6.3.0
+
+Copyright (c) 2017 Olivier Cuisenaire. All rights reserved.
+**/
+
+#ifndef B_TREE_H
+#define B_TREE_H
+
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "BinarySearchTree.h"
+
+/**
+ *  @brief Nombre de clés d'un noeud strictement plus petites que key.
+ *
+ *  Version générique : une comparaison par clé, sans branchement. Les
+ *  spécialisations ci-dessous comparent tout le noeud en quelques instructions
+ *  SIMD quand le type et le jeu d'instructions le permettent.
+ *
+ *  @tparam T type des clés
+ *  @tparam Capacity nombre d'emplacements du noeud (lus même s'ils sont inutilisés)
+ */
+template<typename T, unsigned Capacity, typename Enable = void>
+struct NodeSearch {
+    static unsigned countLess(const T *keys, unsigned n, T key) noexcept {
+        unsigned cnt = 0;
+        for (unsigned i = 0; i < n; ++i)
+            cnt += keys[i] < key;
+        return cnt;
+    }
+};
+
+#if defined(__SSE2__)
+
+/**
+ *  @brief Entiers de 32 bits, 16 clés par noeud : 4 comparaisons SSE2 (2 avec AVX2)
+ *
+ *  Les entiers non signés sont ramenés à des signés en inversant le bit de signe.
+ */
+template<typename T>
+struct NodeSearch<T, 16, typename std::enable_if<std::is_integral<T>::value and sizeof(T) == 4>::type> {
+    static unsigned countLess(const T *keys, unsigned n, T key) noexcept {
+        const int32_t bias = std::is_signed<T>::value ? 0 : INT32_MIN;
+        unsigned mask = 0;
+#if defined(__AVX2__)
+        __m256i k = _mm256_set1_epi32(int32_t(key) ^ bias);
+        __m256i b = _mm256_set1_epi32(bias);
+        for (unsigned j = 0; j < 2; ++j) {
+            __m256i v = _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i *>(keys) + j), b);
+            mask |= unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(k, v)))) << (8 * j);
+        }
+#else
+        __m128i k = _mm_set1_epi32(int32_t(key) ^ bias);
+        __m128i b = _mm_set1_epi32(bias);
+        for (unsigned j = 0; j < 4; ++j) {
+            __m128i v = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i *>(keys) + j), b);
+            mask |= unsigned(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(k, v)))) << (4 * j);
+        }
+#endif
+        // Les clés étant triées, les bits à 1 sont les premiers emplacements utilisés
+        return unsigned(__builtin_popcount(mask & ((1u << n) - 1)));
+    }
+};
+
+#endif
+
+#if defined(__SSE4_2__)
+
+/**
+ *  @brief Entiers de 64 bits, 8 clés par noeud : 4 comparaisons SSE4.2 (2 avec AVX2)
+ */
+template<typename T>
+struct NodeSearch<T, 8, typename std::enable_if<std::is_integral<T>::value and sizeof(T) == 8>::type> {
+    static unsigned countLess(const T *keys, unsigned n, T key) noexcept {
+        const int64_t bias = std::is_signed<T>::value ? 0 : INT64_MIN;
+        unsigned mask = 0;
+#if defined(__AVX2__)
+        __m256i k = _mm256_set1_epi64x(int64_t(key) ^ bias);
+        __m256i b = _mm256_set1_epi64x(bias);
+        for (unsigned j = 0; j < 2; ++j) {
+            __m256i v = _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i *>(keys) + j), b);
+            mask |= unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(k, v)))) << (4 * j);
+        }
+#else
+        __m128i k = _mm_set1_epi64x(int64_t(key) ^ bias);
+        __m128i b = _mm_set1_epi64x(bias);
+        for (unsigned j = 0; j < 4; ++j) {
+            __m128i v = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i *>(keys) + j), b);
+            mask |= unsigned(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(k, v)))) << (2 * j);
+        }
+#endif
+        return unsigned(__builtin_popcount(mask & ((1u << n) - 1)));
+    }
+};
+
+#endif
+
+/**
+ *  @brief B-arbre ordonné pour clés arithmétiques, même interface que BinarySearchTree
+ *         pour insert, contains, deleteElement, min, nth_element, rank et size.
+ *
+ *  Les clés d'un noeud occupent exactement une ligne de cache (16 clés de 32 bits,
+ *  8 de 64 bits) et sont comparées à la clé cherchée en une fois (NodeSearch).
+ *  Un noeud contient au plus Capacity - 1 clés, et au moins Capacity / 2 - 1 sauf
+ *  la racine. Chaque noeud mémorise le nombre de clés de son sous arbre pour
+ *  nth_element et rank.
+ *
+ *  Insertion et suppression se font en une seule descente, en coupant ou en
+ *  complétant les noeuds à l'avance (Cormen et al.) : aucune récursion.
+ *
+ *  @tparam T type arithmétique des clés
+ */
+template<typename T>
+class BTree {
+    static_assert(std::is_arithmetic<T>::value, "BTree est réservé aux clés arithmétiques");
+
+public:
+    using value_type = T;
+    using const_reference = const T &;
+
+private:
+    static const unsigned CacheLine = 64;
+    static const unsigned Capacity = sizeof(T) * 16 <= CacheLine ? 16 : (CacheLine / sizeof(T) >= 4 ? CacheLine / sizeof(T) : 4);
+    static const unsigned MaxKeys = Capacity - 1;   // 2t - 1
+    static const unsigned MinDegree = Capacity / 2; // t
+    // Hauteur maximale : avec au moins deux enfants par noeud interne, 65 niveaux
+    // demanderaient au moins 2^65 - 1 clés
+    static const unsigned MaxHeight = 64;
+
+    /**
+     *  @brief Noeud du B-arbre. Les clés sont en tête, alignées sur une ligne de cache.
+     */
+    struct Node {
+        T keys[Capacity];               // clés triées, seules les count premières sont utilisées
+        Node *children[Capacity + 1];   // count + 1 enfants pour un noeud interne
+        size_t size;                    // nombre de clés dans le sous arbre
+        unsigned short count;           // nombre de clés dans le noeud
+        bool leaf;
+        void *raw;                      // adresse réellement allouée
+
+        explicit Node(bool leaf) : keys(), children(), size(0), count(0), leaf(leaf), raw(nullptr) {}
+    };
+
+    Node *_root;
+
+public:
+    BTree() : _root(nullptr) {}
+
+    /**
+     *  @brief Constucteur de copie.
+     *  @remark Complexité : O(n)
+     */
+    BTree(const BTree &other) : _root(nullptr) {
+        try {
+            _root = clone(other._root);
+        } catch (...) {
+            deleteSubTree(_root);
+            throw;
+        }
+    }
+
+    BTree(BTree &&other) noexcept : _root(other._root) {
+        other._root = nullptr;
+    }
+
+    BTree &operator=(BTree other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void swap(BTree &other) noexcept {
+        std::swap(_root, other._root);
+    }
+
+    ~BTree() {
+        deleteSubTree(_root);
+    }
+
+    //
+    // @brief taille de l'arbre
+    // @remark Complexité : O(1)
+    //
+    size_t size() const noexcept {
+        return _root != nullptr ? _root->size : 0;
+    }
+
+    //
+    // @brief Recherche d'une cle.
+    // @remark Complexité : O(log(n)), une comparaison SIMD par niveau
+    //
+    bool contains(const_reference key) const noexcept {
+        const Node *x = _root;
+        while (x != nullptr) {
+            unsigned i = countLess(x, key);
+            if (i < x->count and !(key < x->keys[i]))
+                return true;
+            x = x->leaf ? nullptr : x->children[i];
+        }
+        return false;
+    }
+
+    //
+    // @brief Insertion d'une cle dans l'arbre
+    // @return vrai si la cle est inseree. faux si elle etait deja presente.
+    // @exception std::bad_alloc si un noeud ne peut être alloué. Chaque coupe
+    //            alloue son noeud avant de modifier l'arbre : les clés de
+    //            l'arbre ne changent pas, seules les coupes déjà faites restent
+    // @remark Complexité : O(log(n)), une seule descente
+    //
+    bool insert(const_reference key) {
+        if (_root == nullptr) {
+            _root = createNode(true);
+        } else if (_root->count == MaxKeys) {
+            if (holds(_root, key))
+                return false;
+            // La racine pleine est coupée, l'arbre grandit par le haut
+            Node *root = createNode(false);
+            Node *sibling;
+            try {
+                sibling = createNode(true);
+            } catch (...) {
+                destroyNode(root);
+                throw;
+            }
+            root->children[0] = _root;
+            root->size = _root->size;
+            _root = root;
+            splitChild(root, 0, sibling);
+        }
+
+        // Noeuds traversés : leur taille n'augmente qu'une fois la clé insérée
+        Node *path[MaxHeight];
+        unsigned depth = 0;
+        Node *x = _root;
+        while (true) {
+            unsigned i = countLess(x, key);
+            if (i < x->count and !(key < x->keys[i]))
+                return false;
+            path[depth++] = x;
+            if (x->leaf) {
+                for (unsigned j = x->count; j > i; --j)
+                    x->keys[j] = x->keys[j - 1];
+                x->keys[i] = key;
+                ++x->count;
+                break;
+            }
+            // On ne descend jamais dans un noeud plein. Il n'est pas coupé s'il contient key
+            Node *c = x->children[i];
+            if (c->count == MaxKeys) {
+                if (holds(c, key))
+                    return false;
+                splitChild(x, i, createNode(true));
+                if (x->keys[i] < key)
+                    ++i;
+            }
+            x = x->children[i];
+        }
+
+        for (unsigned d = 0; d < depth; ++d)
+            ++path[d]->size;
+        return true;
+    }
+
+    //
+    // @brief Supprime l'element de cle key de l'arbre.
+    // @return vrai si l'element etait present
+    // @remark Complexité : O(log(n)), une seule descente
+    //
+    bool deleteElement(const_reference key) noexcept {
+        if (_root == nullptr)
+            return false;
+
+        // Noeuds dont le sous arbre contient la clé supprimée : leur taille ne
+        // diminue qu'une fois la clé trouvée. Compléter ou fusionner les noeuds
+        // en descendant ne change pas les clés, même si key est absente
+        Node *path[MaxHeight];
+        unsigned depth = 0;
+        T target = key;
+        Node *x = _root;
+        while (true) {
+            unsigned i = countLess(x, target);
+            bool found = i < x->count and !(target < x->keys[i]);
+
+            if (x->leaf) {
+                if (!found)
+                    return false;
+                removeKey(x, i);
+                path[depth++] = x;
+                break;
+            }
+
+            Node *next;
+            if (found) {
+                Node *y = x->children[i], *z = x->children[i + 1];
+                // Remplacée par son prédécesseur, qu'on va supprimer dans y
+                if (y->count >= MinDegree) {
+                    target = maxKey(y);
+                    x->keys[i] = target;
+                    next = y;
+                }
+                // Remplacée par son successeur, qu'on va supprimer dans z
+                else if (z->count >= MinDegree) {
+                    target = minKey(z);
+                    x->keys[i] = target;
+                    next = z;
+                }
+                // y et z sont minimaux : fusion avec la clé, qu'on supprime ensuite dans le noeud fusionné
+                else {
+                    next = merge(x, i);
+                }
+            }
+            // On ne descend jamais dans un noeud minimal
+            else if (x->children[i]->count < MinDegree) {
+                next = fill(x, i);
+            } else {
+                next = x->children[i];
+            }
+
+            // Une fusion sous la racine peut l'avoir remplacée par next : x n'existe plus
+            if (next != _root)
+                path[depth++] = x;
+            x = next;
+        }
+
+        for (unsigned d = 0; d < depth; ++d)
+            --path[d]->size;
+
+        if (_root->count == 0) {
+            Node *old = _root;
+            _root = old->leaf ? nullptr : old->children[0];
+            destroyNode(old);
+        }
+        return true;
+    }
+
+    //
+    // @brief Recherche de la cle minimale.
+    // @exception std::logic_error si l'arbre est vide
+    // @remark Complexité : O(log(n))
+    //
+    const_reference min() const {
+        if (_root == nullptr)
+            throw std::logic_error("Impossible to search the min key in an empty tree");
+        const Node *x = _root;
+        while (!x->leaf)
+            x = x->children[0];
+        return x->keys[0];
+    }
+
+    //
+    // @brief cle en position n
+    // @exception std::logic_error si n >= size()
+    // @remark Complexité : O(log(n))
+    //
+    const_reference nth_element(size_t n) const {
+        if (n >= size())
+            throw std::logic_error("Index trop grand");
+
+        const Node *x = _root;
+        while (true) {
+            if (x->leaf)
+                return x->keys[n];
+            for (unsigned i = 0;; ++i) {
+                size_t childSize = x->children[i]->size;
+                if (n < childSize) {
+                    x = x->children[i];
+                    break;
+                }
+                if (n == childSize)
+                    return x->keys[i];
+                n -= childSize + 1;
+            }
+        }
+    }
+
+    //
+    // @brief position d'une cle dans l'ordre croissant
+    // @return la position entre 0 et size()-1, size_t(-1) si la cle est absente
+    // @remark Complexité : O(log(n))
+    //
+    size_t rank(const_reference key) const noexcept {
+        size_t smaller = 0;
+        const Node *x = _root;
+        while (x != nullptr) {
+            unsigned i = countLess(x, key);
+            smaller += i;
+            if (!x->leaf)
+                for (unsigned j = 0; j < i; ++j)
+                    smaller += x->children[j]->size;
+
+            if (i < x->count and !(key < x->keys[i]))
+                return smaller + (x->leaf ? 0 : x->children[i]->size);
+            x = x->leaf ? nullptr : x->children[i];
+        }
+        return size_t(-1);
+    }
+
+    //
+    // @brief Parcours symétrique des cles
+    // @param f une fonction appelée avec chaque cle, par ordre croissant
+    // @remark Complexité : O(n)
+    //
+    template<typename Fn>
+    void visitSym(Fn &&f) const {
+        // (noeud, prochain indice à traiter) pour chaque niveau du chemin courant
+        std::vector<std::pair<const Node *, unsigned>> stack;
+        if (_root != nullptr)
+            stack.emplace_back(_root, 0);
+        while (!stack.empty()) {
+            const Node *x = stack.back().first;
+            unsigned i = stack.back().second;
+            if (x->leaf) {
+                for (unsigned j = 0; j < x->count; ++j)
+                    f(x->keys[j]);
+                stack.pop_back();
+            } else if (i <= x->count) {
+                // Avant de descendre dans l'enfant i, on visite la clé i - 1
+                if (i > 0)
+                    f(x->keys[i - 1]);
+                ++stack.back().second;
+                stack.emplace_back(x->children[i], 0);
+            } else {
+                stack.pop_back();
+            }
+        }
+    }
+
+    //
+    // @brief hauteur de l'arbre, en noeuds. Toutes les feuilles sont à la même profondeur
+    // @remark Complexité : O(log(n))
+    //
+    size_t height() const noexcept {
+        size_t h = 0;
+        for (const Node *x = _root; x != nullptr; x = x->leaf ? nullptr : x->children[0])
+            ++h;
+        return h;
+    }
+
+private:
+    static unsigned countLess(const Node *x, const_reference key) noexcept {
+        return NodeSearch<T, Capacity>::countLess(x->keys, x->count, key);
+    }
+
+    static size_t subtreeSize(const Node *x) noexcept {
+        size_t s = x->count;
+        if (!x->leaf)
+            for (unsigned i = 0; i <= x->count; ++i)
+                s += x->children[i]->size;
+        return s;
+    }
+
+    /**
+     * @brief Alloue un noeud dont les clés commencent sur une ligne de cache
+     */
+    static Node *createNode(bool leaf) {
+        void *raw = ::operator new(sizeof(Node) + CacheLine);
+        uintptr_t aligned = (reinterpret_cast<uintptr_t>(raw) + CacheLine - 1) & ~uintptr_t(CacheLine - 1);
+        Node *n = new(reinterpret_cast<void *>(aligned)) Node(leaf);
+        n->raw = raw;
+        return n;
+    }
+
+    static void destroyNode(Node *n) noexcept {
+        void *raw = n->raw;
+        n->~Node();
+        ::operator delete(raw);
+    }
+
+    // vrai si le noeud x lui-même contient key
+    static bool holds(const Node *x, const_reference key) noexcept {
+        unsigned i = countLess(x, key);
+        return i < x->count and !(key < x->keys[i]);
+    }
+
+    /**
+     * @brief Coupe l'enfant plein i de x en deux, la clé médiane remonte dans x
+     * @param x un noeud non plein
+     * @param i l'indice de l'enfant plein
+     * @param z un noeud vide qui reçoit la moitié haute
+     */
+    static void splitChild(Node *x, unsigned i, Node *z) noexcept {
+        Node *y = x->children[i];
+        z->leaf = y->leaf;
+        z->count = MinDegree - 1;
+        for (unsigned j = 0; j < MinDegree - 1; ++j)
+            z->keys[j] = y->keys[j + MinDegree];
+        if (!y->leaf)
+            for (unsigned j = 0; j < MinDegree; ++j)
+                z->children[j] = y->children[j + MinDegree];
+        y->count = MinDegree - 1;
+        z->size = subtreeSize(z);
+        y->size = subtreeSize(y);
+
+        for (unsigned j = x->count; j > i; --j) {
+            x->keys[j] = x->keys[j - 1];
+            x->children[j + 1] = x->children[j];
+        }
+        x->keys[i] = y->keys[MinDegree - 1];
+        x->children[i + 1] = z;
+        ++x->count;
+    }
+
+    static void removeKey(Node *x, unsigned i) noexcept {
+        for (unsigned j = i + 1; j < x->count; ++j)
+            x->keys[j - 1] = x->keys[j];
+        --x->count;
+    }
+
+    static T maxKey(const Node *x) noexcept {
+        while (!x->leaf)
+            x = x->children[x->count];
+        return x->keys[x->count - 1];
+    }
+
+    static T minKey(const Node *x) noexcept {
+        while (!x->leaf)
+            x = x->children[0];
+        return x->keys[0];
+    }
+
+    /**
+     * @brief Fusionne les enfants i et i + 1 de x autour de la clé i
+     * @return le noeud fusionné. Si x était la racine et se retrouve vide, il est remplacé
+     */
+    Node *merge(Node *x, unsigned i) noexcept {
+        Node *y = x->children[i], *z = x->children[i + 1];
+        y->keys[y->count] = x->keys[i];
+        for (unsigned j = 0; j < z->count; ++j)
+            y->keys[y->count + 1 + j] = z->keys[j];
+        if (!y->leaf)
+            for (unsigned j = 0; j <= z->count; ++j)
+                y->children[y->count + 1 + j] = z->children[j];
+        y->count += z->count + 1;
+        y->size += z->size + 1;
+
+        for (unsigned j = i + 1; j < x->count; ++j) {
+            x->keys[j - 1] = x->keys[j];
+            x->children[j] = x->children[j + 1];
+        }
+        --x->count;
+        destroyNode(z);
+
+        if (x == _root and x->count == 0) {
+            _root = y;
+            destroyNode(x);
+        }
+        return y;
+    }
+
+    /**
+     * @brief Complète l'enfant minimal i de x en empruntant une clé à un frère, sinon en fusionnant
+     * @return le noeud dans lequel poursuivre la descente
+     */
+    Node *fill(Node *x, unsigned i) noexcept {
+        Node *c = x->children[i];
+
+        // Emprunt au frère gauche : la clé i - 1 de x descend, la dernière du frère monte
+        if (i > 0 and x->children[i - 1]->count >= MinDegree) {
+            Node *left = x->children[i - 1];
+            for (unsigned j = c->count; j > 0; --j)
+                c->keys[j] = c->keys[j - 1];
+            c->keys[0] = x->keys[i - 1];
+            size_t moved = 1;
+            if (!c->leaf) {
+                for (unsigned j = c->count + 1; j > 0; --j)
+                    c->children[j] = c->children[j - 1];
+                c->children[0] = left->children[left->count];
+                moved += c->children[0]->size;
+            }
+            x->keys[i - 1] = left->keys[left->count - 1];
+            --left->count;
+            ++c->count;
+            left->size -= moved;
+            c->size += moved;
+            return c;
+        }
+
+        // Emprunt au frère droit : la clé i de x descend, la première du frère monte
+        if (i < x->count and x->children[i + 1]->count >= MinDegree) {
+            Node *right = x->children[i + 1];
+            c->keys[c->count] = x->keys[i];
+            size_t moved = 1;
+            if (!c->leaf) {
+                c->children[c->count + 1] = right->children[0];
+                moved += right->children[0]->size;
+                for (unsigned j = 0; j < right->count; ++j)
+                    right->children[j] = right->children[j + 1];
+            }
+            x->keys[i] = right->keys[0];
+            removeKey(right, 0);
+            ++c->count;
+            right->size -= moved;
+            c->size += moved;
+            return c;
+        }
+
+        // Les deux frères sont minimaux
+        return i < x->count ? merge(x, i) : merge(x, i - 1);
+    }
+
+    Node *clone(const Node *src) {
+        if (src == nullptr)
+            return nullptr;
+        Node *root = createNode(src->leaf);
+        // (original, copie) dont les enfants restent à copier
+        std::vector<std::pair<const Node *, Node *>> stack;
+        stack.emplace_back(src, root);
+        while (!stack.empty()) {
+            const Node *s = stack.back().first;
+            Node *d = stack.back().second;
+            stack.pop_back();
+            for (unsigned j = 0; j < s->count; ++j)
+                d->keys[j] = s->keys[j];
+            d->count = s->count;
+            d->size = s->size;
+            if (!s->leaf) {
+                for (unsigned j = 0; j <= s->count; ++j) {
+                    d->children[j] = createNode(s->children[j]->leaf);
+                    stack.emplace_back(s->children[j], d->children[j]);
+                }
+            }
+        }
+        return root;
+    }
+
+    /**
+     * @brief Libère un sous arbre sans allouer
+     *
+     * On descend toujours par le dernier enfant restant, dont l'emplacement garde
+     * le parent du noeud (inversion des liens) : la remontée suit ces emplacements,
+     * et count désigne l'enfant en cours. Les enfants nuls d'une copie interrompue
+     * sont ignorés.
+     */
+    static void deleteSubTree(Node *root) noexcept {
+        Node *parent = nullptr;
+        Node *x = root;
+        for (;;) {
+            while (x != nullptr and !x->leaf) {
+                Node *child = x->children[x->count];
+                x->children[x->count] = parent;
+                parent = x;
+                x = child;
+            }
+            if (x != nullptr)
+                destroyNode(x);
+
+            // L'enfant parent->children[parent->count] est libéré : on passe à son frère gauche
+            // ou, s'il n'y en a plus, on libère le parent et on remonte
+            for (;;) {
+                if (parent == nullptr)
+                    return;
+                unsigned i = parent->count;
+                Node *up = parent->children[i];
+                if (i != 0) {
+                    x = parent->children[i - 1];
+                    parent->children[i - 1] = up;
+                    parent->count = static_cast<unsigned short>(i - 1);
+                    break;
+                }
+                destroyNode(parent);
+                parent = up;
+            }
+        }
+    }
+};
+
+/**
+ *  @brief Choix du conteneur ordonné selon le type des clés : BTree pour les types
+ *         arithmétiques, BinarySearchTree pour tous les autres.
+ */
+template<typename T, bool = std::is_arithmetic<T>::value>
+struct OrderedSetSelector {
+    using type = BinarySearchTree<T>;
+};
+
+template<typename T>
+struct OrderedSetSelector<T, true> {
+    using type = BTree<T>;
+};
+
+template<typename T>
+using OrderedSet = typename OrderedSetSelector<T>::type;
+
+#endif // B_TREE_H
@@ -0,0 +1,235 @@
+/**
+-----------------------------------------------------------------------------------
+Laboratoire : 09
+\file       BinarySearchMap.h
+\author     Loïc Dessaules, Doran Kayoumi, Gabrielle Thurnherr
+\date       16/10/2026
+\brief      Tableau associatif ordonné (clé -> valeur) construit sur
+            BinarySearchTree
+Compilateur MinGW-gcc 6.3.0
+
+Copyright (c) 2017 Olivier Cuisenaire. All rights reserved.
+**/
+
+#ifndef BINARY_SEARCH_MAP_H
+#define BINARY_SEARCH_MAP_H
+
+#include <utility>
+#include <stdexcept>
+
+#include "BinarySearchTree.h"
+
+/**
+ *  @brief Entrée d'un BinarySearchMap : la clé ordonne l'arbre et ne change
+ *         jamais, la valeur peut être modifiée sur place au travers des
+ *         itérateurs constants de l'arbre.
+ */
+template<typename K, typename V>
+struct MapEntry {
+    const K first;
+    mutable V second;
+
+    template<typename... Args>
+    explicit MapEntry(const K &key, Args &&... args) : first(key), second(std::forward<Args>(args)...) {}
+
+    template<typename... Args>
+    explicit MapEntry(K &&key, Args &&... args) : first(std::move(key)), second(std::forward<Args>(args)...) {}
+};
+
+/**
+ *  @brief Ordre des entrées, par leur clé seulement. Transparent : l'arbre peut
+ *         être interrogé directement avec une clé K, sans construire d'entrée.
+ */
+template<typename K, typename V, typename Compare>
+struct MapEntryCompare {
+    using is_transparent = void;
+    using Entry = MapEntry<K, V>;
+
+    Compare comp;
+
+    explicit MapEntryCompare(const Compare &c = Compare()) : comp(c) {}
+
+    bool operator()(const Entry &a, const Entry &b) const { return comp(a.first, b.first); }
+
+    bool operator()(const K &a, const Entry &b) const { return comp(a, b.first); }
+
+    bool operator()(const Entry &a, const K &b) const { return comp(a.first, b); }
+
+    // Comparaison à trois issues, un seul appel par noeud si Compare en a une
+    int compare(const Entry &a, const Entry &b) const { return compareThreeWay(comp, a.first, b.first); }
+
+    int compare(const K &a, const Entry &b) const { return compareThreeWay(comp, a, b.first); }
+
+    int compare(const Entry &a, const K &b) const { return compareThreeWay(comp, a.first, b); }
+};
+
+/**
+ *  @brief Tableau associatif ordonné : chaque clé unique est associée à une
+ *         valeur. Même structure et mêmes garanties que BinarySearchTree, dont il
+ *         reprend les politiques.
+ *
+ *  Les itérateurs parcourent les entrées par clé croissante. it->second peut
+ *  être modifié sur place, it->first jamais.
+ *
+ *  @tparam K type des clés
+ *  @tparam V type des valeurs
+ *  @tparam Compare ordre strict des clés
+ */
+template<typename K, typename V, typename Balance = NoBalance,
+        typename Allocator = std::allocator<MapEntry<K, V>>, typename Tracer = NoTrace,
+        typename Compare = ThreeWayLess>
+class BinarySearchMap {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = MapEntry<K, V>;
+    using key_compare = Compare;
+    using tree_type = BinarySearchTree<value_type, Balance, Allocator, Tracer, MapEntryCompare<K, V, Compare>>;
+    using const_iterator = typename tree_type::const_iterator;
+    using iterator = const_iterator;
+
+    BinarySearchMap() : _tree(MapEntryCompare<K, V, Compare>()) {}
+
+    explicit BinarySearchMap(const Compare &comp, const Allocator &alloc = Allocator())
+            : _tree(MapEntryCompare<K, V, Compare>(comp), alloc) {}
+
+    //
+    // @brief nombre d'entrées
+    // @remark Complexité : O(1)
+    //
+    size_t size() const noexcept {
+        return _tree.size();
+    }
+
+    bool empty() const noexcept {
+        return _tree.size() == 0;
+    }
+
+    const_iterator begin() const noexcept { return _tree.begin(); }
+
+    const_iterator end() const noexcept { return _tree.end(); }
+
+    //
+    // @brief Valeur associée à key, insérée (construite par défaut) si key est absente
+    // @remark Complexité moyenne : O(log(n)), une seule descente
+    //
+    V &operator[](const K &key) {
+        return _tree.tryEmplace(key, key).first->second;
+    }
+
+    // key n'est déplacée dans l'entrée que si elle est absente
+    V &operator[](K &&key) {
+        return _tree.tryEmplace(key, std::move(key)).first->second;
+    }
+
+    //
+    // @brief Valeur associée à key
+    // @exception std::logic_error si key est absente
+    // @remark Complexité moyenne : O(log(n))
+    //
+    V &at(const K &key) {
+        return entry(key).second;
+    }
+
+    const V &at(const K &key) const {
+        return entry(key).second;
+    }
+
+    //
+    // @brief Insertion d'une entrée construite sur place
+    //
+    // @param key la clé de l'entrée
+    // @param args les arguments du constructeur de la valeur, utilisés seulement
+    //             si key est absente
+    // @return un itérateur sur l'entrée de key, et vrai si elle vient d'être insérée.
+    //         Une valeur déjà présente n'est pas modifiée
+    // @remark Complexité moyenne : O(log(n))
+    //
+    template<typename... Args>
+    std::pair<const_iterator, bool> emplace(const K &key, Args &&... args) {
+        return _tree.tryEmplace(key, key, std::forward<Args>(args)...);
+    }
+
+    std::pair<const_iterator, bool> insert(const K &key, const V &value) {
+        return emplace(key, value);
+    }
+
+    //
+    // @brief Associe value à key, que key soit présente ou non
+    // @return un itérateur sur l'entrée de key, et vrai si elle vient d'être insérée
+    // @remark Complexité moyenne : O(log(n))
+    //
+    template<typename U>
+    std::pair<const_iterator, bool> insertOrAssign(const K &key, U &&value) {
+        std::pair<const_iterator, bool> r = _tree.tryEmplace(key, key, std::forward<U>(value));
+        if (!r.second)
+            r.first->second = std::forward<U>(value);
+        return r;
+    }
+
+    //
+    // @brief Modifie sur place la valeur associée à key
+    //
+    // @param fn appelée avec une référence sur la valeur
+    // @return vrai si key est présente, faux sinon (fn n'est alors pas appelée)
+    // @remark Complexité moyenne : O(log(n)), sans copie de la valeur
+    //
+    template<typename Fn>
+    bool update(const K &key, Fn &&fn) {
+        const_iterator it = _tree.find(key);
+        if (it == _tree.end())
+            return false;
+        fn(it->second);
+        return true;
+    }
+
+    //
+    // @brief Recherche d'une clé
+    // @return un itérateur sur son entrée, end() si elle est absente
+    // @remark Complexité moyenne : O(log(n))
+    //
+    const_iterator find(const K &key) const noexcept {
+        return _tree.find(key);
+    }
+
+    bool contains(const K &key) const noexcept {
+        return _tree.contains(key);
+    }
+
+    // Première entrée dont la clé n'est pas plus petite que key
+    const_iterator lower_bound(const K &key) const noexcept {
+        return _tree.lower_bound(key);
+    }
+
+    // Première entrée dont la clé est strictement plus grande que key
+    const_iterator upper_bound(const K &key) const noexcept {
+        return _tree.upper_bound(key);
+    }
+
+    //
+    // @brief Supprime l'entrée de key
+    // @return vrai si elle était présente
+    // @remark Complexité moyenne : O(log(n))
+    //
+    bool erase(const K &key) noexcept {
+        return _tree.deleteElement(key);
+    }
+
+    // L'arbre des entrées, pour les opérations qui ne dépendent pas des valeurs
+    const tree_type &tree() const noexcept {
+        return _tree;
+    }
+
+private:
+    // entrée de key, dont la valeur reste modifiable (voir MapEntry)
+    const value_type &entry(const K &key) const {
+        const_iterator it = _tree.find(key);
+        if (it == _tree.end())
+            throw std::logic_error("Cle absente");
+        return *it;
+    }
+
+    tree_type _tree;
+};
+
+#endif // BINARY_SEARCH_MAP_H
@@ -10,18 +10,522 @@ Compilateur MinGW-gcc 6.3.0
 Copyright (c) 2017 Olivier Cuisenaire. All rights reserved.
 **/
 
+#ifndef BINARY_SEARCH_TREE_H
+#define BINARY_SEARCH_TREE_H
+
 #include <cstdlib>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <string>
 #include <queue>
+#include <vector>
 #include <cassert>
 #include <stdexcept>
+#include <algorithm>
+#include <memory>
+#include <forward_list>
+#include <cstddef>
+#include <type_traits>
+#include <atomic>
+#include <iterator>
+#include <utility>
+#include <thread>
+#include <future>
+#include <functional>
+#include <system_error>
+#include <limits>
+
+#include "FrozenBinarySearchTree.h"
+#include "SnapshotBinarySearchTree.h"
+#include "BinarySearchTreeStream.h"
 
 using namespace std;
 
-template<typename T>
+/**
+ *  @brief Politique d'équilibrage par défaut : l'arbre n'est jamais rééquilibré
+ *         automatiquement, seul un appel explicite à balance() le fait.
+ */
+struct NoBalance {
+    struct NodeData {};
+};
+
+/**
+ *  @brief Politique d'équilibrage AVL : chaque noeud mémorise la hauteur de son
+ *         sous-arbre et des rotations sont effectuées en remontant après chaque
+ *         insertion ou suppression, ce qui garantit une hauteur en O(log(n)).
+ */
+struct AVLBalance {
+    struct NodeData {
+        unsigned height = 1; // hauteur du sous arbre dont ce noeud est la racine
+    };
+};
+
+/**
+ *  @brief Politique d'équilibrage par les poids (arbre bouc émissaire) : aucun champ
+ *         de plus par noeud, seul nbElements est utilisé.
+ *
+ *  Après chaque insertion ou suppression, le plus haut noeud du chemin modifié dont
+ *  un sous arbre contient plus de alpha fois ses éléments est reconstruit
+ *  parfaitement équilibré (linéarisation puis arborisation). Un sous arbre de m
+ *  noeuds n'est reconstruit qu'après O(m) modifications en dessous de lui :
+ *  le coût est O(log(n)) amorti, et la hauteur reste inférieure à log_{1/alpha}(n).
+ *  Hormis ces reconstructions, l'arbre se comporte comme avec NoBalance.
+ */
+struct ScapegoatBalance : NoBalance {
+    struct Stats {
+        size_t rebuilds = 0;     // nombre de sous arbres reconstruits
+        size_t rebuiltNodes = 0; // total des noeuds replacés, soit le coût des reconstructions
+        size_t largest = 0;      // taille du plus grand sous arbre reconstruit
+    };
+
+    double alpha = 0.7; // dans [0.5, 1) : plus il est petit, plus l'arbre est bas et les reconstructions fréquentes
+    Stats stats;
+};
+
+/**
+ *  @brief Politique d'augmentation par défaut : aucun résumé par noeud, seul
+ *         nbElements est maintenu.
+ */
+struct NoAugment {
+    using summary_type = void;
+
+    struct NodeData {};
+};
+
+/**
+ *  @brief Base des politiques d'augmentation par un monoïde.
+ *
+ *  Chaque noeud mémorise le résumé de son sous arbre,
+ *      combine(combine(résumé gauche, measure(clé)), résumé droit),
+ *  tenu à jour comme nbElements par les insertions, suppressions, rotations et
+ *  reconstructions. aggregate(lo, hi) combine alors les clés d'un intervalle
+ *  dans l'ordre croissant en O(log(n)), sans les parcourir.
+ *
+ *  Une politique dérive de MonoidAugment<V> et fournit :
+ *      static V identity();                        // neutre de combine
+ *      static V measure(const T &key);             // résumé d'une seule clé
+ *      static V combine(const V &a, const V &b);   // associative, pas forcément commutative
+ *  Ces fonctions ne doivent pas lever d'exception : elles sont appelées pendant
+ *  les suppressions et les rotations, qui n'en lèvent pas.
+ */
+template<typename V>
+struct MonoidAugment {
+    using summary_type = V;
+
+    struct NodeData {
+        V summary; // résumé du sous arbre dont ce noeud est la racine
+    };
+};
+
+// Somme des clés, converties en V
+template<typename V>
+struct SumAugment : MonoidAugment<V> {
+    static V identity() { return V(); }
+
+    template<typename K>
+    static V measure(const K &key) { return V(key); }
+
+    static V combine(const V &a, const V &b) { return a + b; }
+};
+
+// Plus petite clé, convertie en V ; numeric_limits<V>::max() pour un intervalle vide
+template<typename V>
+struct MinAugment : MonoidAugment<V> {
+    static V identity() { return std::numeric_limits<V>::max(); }
+
+    template<typename K>
+    static V measure(const K &key) { return V(key); }
+
+    static V combine(const V &a, const V &b) { return b < a ? b : a; }
+};
+
+// Plus grande clé, convertie en V ; numeric_limits<V>::lowest() pour un intervalle vide
+template<typename V>
+struct MaxAugment : MonoidAugment<V> {
+    static V identity() { return std::numeric_limits<V>::lowest(); }
+
+    template<typename K>
+    static V measure(const K &key) { return V(key); }
+
+    static V combine(const V &a, const V &b) { return a < b ? b : a; }
+};
+
+/**
+ *  @brief Clés uniques (par défaut) : l'insertion d'une clé déjà présente est ignorée.
+ */
+struct UniqueKeys {
+    struct NodeData {};
+};
+
+/**
+ *  @brief Multiensemble : chaque noeud compte les occurrences de sa clé.
+ *
+ *  Une clé insérée n fois n'occupe qu'un noeud, quelle que soit n. Comme pour
+ *  std::multiset, toutes les opérations voient ses n occurrences : size(), rank,
+ *  nth_element, countRange et aggregate les comptent, les itérateurs, les
+ *  parcours (visitSym, forEachInRange, reduce, ...) et freeze les présentent
+ *  l'une après l'autre. deleteElement et deleteMin retirent une seule occurrence.
+ */
+struct MultipleKeys {
+    struct NodeData {
+        size_t multiplicity = 1; // occurrences de la clé du noeud
+    };
+};
+
+/**
+ *  @brief Pools partagés par un PoolAllocator et tous les allocateurs obtenus
+ *         par copie ou par rebind : un pool par taille et alignement d'emplacement.
+ *
+ *  @tparam SlotsPerBlock nombre d'emplacements de chaque bloc
+ */
+template<size_t SlotsPerBlock>
+class PoolArenas {
+public:
+    /**
+     * @brief Pool d'emplacements de même taille.
+     *        Le premier emplacement de chaque bloc chaîne les blocs entre eux.
+     */
+    struct Arena {
+        struct Link {
+            Link *next;
+        };
+
+        const size_t slotSize;    // multiple de slotAlign, au moins sizeof(Link)
+        const size_t slotAlign;
+        Link *freeList = nullptr; // emplacements libérés, réutilisés en priorité
+        char *cursor = nullptr;   // prochain emplacement jamais utilisé du bloc courant
+        char *end = nullptr;      // fin du bloc courant
+        Link *blocks = nullptr;   // dernier bloc alloué
+
+        Arena(size_t slotSize, size_t slotAlign) noexcept : slotSize(slotSize), slotAlign(slotAlign) {}
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+        ~Arena() {
+            while (blocks != nullptr) {
+                Link *next = blocks->next;
+                ::operator delete(blocks);
+                blocks = next;
+            }
+        }
+
+        void *allocate() {
+            if (freeList != nullptr) {
+                Link *s = freeList;
+                freeList = s->next;
+                return s;
+            }
+            if (cursor == end) {
+                char *block = static_cast<char *>(::operator new(SlotsPerBlock * slotSize));
+                Link *link = reinterpret_cast<Link *>(block);
+                link->next = blocks;
+                blocks = link;
+                cursor = block + slotSize;
+                end = block + SlotsPerBlock * slotSize;
+            }
+            void *p = cursor;
+            cursor += slotSize;
+            return p;
+        }
+
+        void deallocate(void *p) noexcept {
+            Link *s = static_cast<Link *>(p);
+            s->next = freeList;
+            freeList = s;
+        }
+    };
+
+    PoolArenas() = default;
+    PoolArenas(const PoolArenas &) = delete;
+    PoolArenas &operator=(const PoolArenas &) = delete;
+
+    //
+    // @brief pool des emplacements de cette taille et de cet alignement, nullptr s'il n'existe pas
+    //
+    Arena *find(size_t slotSize, size_t slotAlign) noexcept {
+        for (Arena &arena : _arenas)
+            if (arena.slotSize == slotSize and arena.slotAlign == slotAlign)
+                return &arena;
+        return nullptr;
+    }
+
+    //
+    // @brief pool des emplacements de cette taille et de cet alignement, créé au besoin
+    // @exception std::bad_alloc
+    //
+    Arena &arena(size_t slotSize, size_t slotAlign) {
+        if (Arena *existing = find(slotSize, slotAlign))
+            return *existing;
+        _arenas.emplace_front(slotSize, slotAlign);
+        return _arenas.front();
+    }
+
+private:
+    std::forward_list<Arena> _arenas; // quelques types de noeuds au plus : une recherche linéaire suffit
+};
+
+/**
+ *  @brief Allocateur par blocs (arena) pour les noeuds de l'arbre.
+ *
+ *  Les objets sont découpés dans des blocs contigus de SlotsPerBlock emplacements.
+ *  Un objet libéré est chaîné dans une liste libre et réutilisé par l'allocation
+ *  suivante. Les blocs ne sont rendus au système qu'en une fois, quand la dernière
+ *  copie de l'allocateur (donc l'arbre qui le possède) est détruite.
+ *
+ *  Seules les allocations d'un objet unique passent par le pool, les autres sont
+ *  déléguées à l'opérateur new. Les copies et les allocateurs obtenus par rebind
+ *  partagent les pools de l'original (PoolArenas) et lui sont égaux : deux arbres
+ *  construits avec le même allocateur peuvent échanger leurs noeuds (join, unionWith).
+ *  Cet allocateur n'est pas thread-safe.
+ */
+template<typename T, size_t SlotsPerBlock = 1024>
+class PoolAllocator {
+    static_assert(SlotsPerBlock > 1, "Un bloc doit contenir au moins un emplacement utilisable");
+
+    using Pools = PoolArenas<SlotsPerBlock>;
+    using Arena = typename Pools::Arena;
+
+    /**
+     * @brief Emplacement d'un objet. Quand il est libre, il sert de maillon à la liste libre.
+     */
+    union Slot {
+        typename Arena::Link link;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    template<typename U, size_t N> friend class PoolAllocator;
+
+    std::shared_ptr<Pools> _pools;
+    Arena *_arena; // pool des emplacements de T, cherché à la première utilisation
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    template<typename U>
+    struct rebind {
+        using other = PoolAllocator<U, SlotsPerBlock>;
+    };
+
+    PoolAllocator() : _pools(std::make_shared<Pools>()), _arena(nullptr) {}
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U, SlotsPerBlock> &other) noexcept : _pools(other._pools), _arena(nullptr) {}
+
+    T *allocate(size_t n) {
+        if (n != 1)
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        if (_arena == nullptr)
+            _arena = &_pools->arena(sizeof(Slot), alignof(Slot));
+        return static_cast<T *>(_arena->allocate());
+    }
+
+    void deallocate(T *p, size_t n) noexcept {
+        if (n != 1) {
+            ::operator delete(p);
+            return;
+        }
+        // p vient d'un allocateur égal : son pool existe déjà
+        if (_arena == nullptr)
+            _arena = _pools->find(sizeof(Slot), alignof(Slot));
+        _arena->deallocate(p);
+    }
+
+    /**
+     * @brief Une copie d'arbre reçoit son propre pool plutôt que de partager celui de l'original
+     */
+    PoolAllocator select_on_container_copy_construction() const {
+        return PoolAllocator();
+    }
+
+    template<typename U>
+    bool operator==(const PoolAllocator<U, SlotsPerBlock> &other) const noexcept {
+        return _pools == other._pools;
+    }
+
+    template<typename U>
+    bool operator!=(const PoolAllocator<U, SlotsPerBlock> &other) const noexcept {
+        return !(*this == other);
+    }
+};
+
+/**
+ *  @brief Politique de traçage par défaut : les évènements du cycle de vie des
+ *         noeuds sont ignorés, sans aucun coût à l'exécution.
+ *
+ *  Toute classe fournissant les deux fonctions statiques ci-dessous peut servir
+ *  de politique de traçage, par exemple pour transmettre les évènements à une
+ *  fonction de rappel de l'application.
+ */
+struct NoTrace {
+    template<typename T>
+    static void nodeCreated(const T &) noexcept {}
+
+    template<typename T>
+    static void nodeDestroyed(const T &) noexcept {}
+};
+
+/**
+ *  @brief Politique de traçage reproduisant l'affichage historique des noeuds :
+ *         (Ccle) à la construction et (Dcle) à la destruction, sur cout.
+ */
+struct ConsoleTrace {
+    template<typename T>
+    static void nodeCreated(const T &key) {
+        cout << "(C" << key << ") ";
+    }
+
+    template<typename T>
+    static void nodeDestroyed(const T &key) noexcept {
+        cout << "(D" << key << ") ";
+    }
+};
+
+/**
+ *  @brief Politique de traçage enregistrant les évènements dans un tampon circulaire
+ *         sans verrou, partagé par tous les arbres utilisant ce type.
+ *
+ *  Les écrivains réservent un emplacement par incrément atomique, les plus anciens
+ *  évènements sont écrasés quand le tampon est plein. Chaque emplacement porte un
+ *  numéro de séquence qui permet au lecteur d'ignorer ceux en cours d'écriture.
+ *  T doit être trivialement copiable.
+ */
+template<typename T, size_t Capacity = 4096>
+class RingBufferTrace {
+public:
+    enum class Event : unsigned char { Created, Destroyed };
+
+    struct Record {
+        Event event;
+        T key;
+    };
+
+    static void nodeCreated(const T &key) noexcept {
+        push(Event::Created, key);
+    }
+
+    static void nodeDestroyed(const T &key) noexcept {
+        push(Event::Destroyed, key);
+    }
+
+    /**
+     * @brief Nombre total d'évènements enregistrés depuis le lancement
+     */
+    static size_t total() noexcept {
+        return _head.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Copie les évènements encore présents dans le tampon, du plus ancien au plus récent
+     * @param out itérateur de sortie recevant des Record
+     * @return le nombre d'évènements copiés
+     */
+    template<typename OutputIt>
+    static size_t snapshot(OutputIt out) {
+        size_t head = total();
+        size_t first = head > Capacity ? head - Capacity : 0;
+        size_t copied = 0;
+        for (size_t i = first; i < head; ++i) {
+            const Slot &slot = _slots[i % Capacity];
+            if (slot.seq.load(std::memory_order_acquire) != i + 1)
+                continue;
+            Record r = slot.record;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // L'emplacement a été réécrit pendant la copie
+            if (slot.seq.load(std::memory_order_relaxed) != i + 1)
+                continue;
+            *out++ = r;
+            ++copied;
+        }
+        return copied;
+    }
+
+private:
+    static_assert(std::is_trivially_copyable<T>::value, "RingBufferTrace requiert des clés trivialement copiables");
+
+    struct Slot {
+        std::atomic<size_t> seq; // index de l'évènement + 1, 0 pendant l'écriture
+        Record record;
+    };
+
+    static void push(Event event, const T &key) noexcept {
+        size_t i = _head.fetch_add(1, std::memory_order_acq_rel);
+        Slot &slot = _slots[i % Capacity];
+        slot.seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.record.event = event;
+        slot.record.key = key;
+        slot.seq.store(i + 1, std::memory_order_release);
+    }
+
+    static std::atomic<size_t> _head;
+    static Slot _slots[Capacity];
+};
+
+template<typename T, size_t Capacity>
+std::atomic<size_t> RingBufferTrace<T, Capacity>::_head(0);
+
+template<typename T, size_t Capacity>
+typename RingBufferTrace<T, Capacity>::Slot RingBufferTrace<T, Capacity>::_slots[Capacity];
+
+/**
+ *  @brief Comparateur par défaut : operator<, transparent (recherches hétérogènes).
+ *
+ *  compare(a, b) donne en un seul appel le résultat d'une comparaison à trois
+ *  issues (< 0, 0, > 0), avec a.compare(b) quand les clés en fournissent une
+ *  (std::string, ...), et sinon avec deux appels à operator<.
+ */
+struct ThreeWayLess {
+    using is_transparent = void;
+
+    template<typename A, typename B>
+    auto operator()(const A &a, const B &b) const -> decltype(a < b) {
+        return a < b;
+    }
+
+    template<typename A, typename B>
+    int compare(const A &a, const B &b) const {
+        return compare(a, b, 0);
+    }
+
+private:
+    template<typename A, typename B>
+    static auto compare(const A &a, const B &b, int) -> decltype(int(a.compare(b))) {
+        return a.compare(b);
+    }
+
+    template<typename A, typename B>
+    static int compare(const A &a, const B &b, long) {
+        return a < b ? -1 : (b < a ? 1 : 0);
+    }
+};
+
+// Variantes de compareThreeWay, choisies par surcharge : int est préféré à long
+template<typename C, typename A, typename B>
+auto compareThreeWay(const C &comp, const A &a, const B &b, int) -> decltype(int(comp.compare(a, b))) {
+    return comp.compare(a, b);
+}
+
+template<typename C, typename A, typename B>
+int compareThreeWay(const C &comp, const A &a, const B &b, long) {
+    return comp(a, b) ? -1 : (comp(b, a) ? 1 : 0);
+}
+
+/**
+ *  @brief Comparaison à trois issues avec un comparateur quelconque : comp.compare
+ *         s'il en a une, sinon deux appels à comp
+ *  @return < 0 si a est avant b, 0 si elles sont équivalentes, > 0 sinon
+ */
+template<typename C, typename A, typename B>
+int compareThreeWay(const C &comp, const A &a, const B &b) {
+    return compareThreeWay(comp, a, b, 0);
+}
+
+template<typename T, typename Balance = NoBalance, typename Allocator = std::allocator<T>, typename Tracer = NoTrace,
+        typename Compare = ThreeWayLess, typename Augment = NoAugment, typename Keys = UniqueKeys>
 class BinarySearchTree {
 public:
 
@@ -29,28 +533,49 @@ public:
     using reference = T &;
     using const_reference = const T &;
     using pointer = T *;
+    using balance_policy = Balance;
+    using allocator_type = Allocator;
+    using tracer_type = Tracer;
+    using key_compare = Compare;
+    using augment_policy = Augment;
+    using summary_type = typename Augment::summary_type;
+    using keys_policy = Keys;
+
+    // vrai en mode multiensemble, voir MultipleKeys
+    static const bool IsMultiset = std::is_same<Keys, MultipleKeys>::value;
+
+    // Les critères de ScapegoatBalance portent sur le nombre de noeuds, que nbElements ne donne plus
+    static_assert(!IsMultiset or !std::is_base_of<ScapegoatBalance, Balance>::value,
+                  "Le mode multiensemble n'est pas disponible avec ScapegoatBalance");
 
 private:
     /**
      *  @brief Noeud de l'arbre.
      *
      * contient une cle et les liens vers les sous-arbres droit et gauche.
+     * Les données propres à la politique d'équilibrage sont héritées de
+     * Balance::NodeData (vide, donc sans surcoût, pour NoBalance), le
+     * résumé de la politique d'augmentation de Augment::NodeData et la
+     * multiplicité de la clé de Keys::NodeData.
      */
-    struct Node {
+    struct Node : Balance::NodeData, Augment::NodeData, Keys::NodeData {
         const value_type key; // clé non modifiable
         Node *right;          // sous arbre avec des cles plus grandes
         Node *left;           // sous arbre avec des cles plus petites
-        size_t nbElements;    // nombre de noeuds dans le sous arbre dont
-        // ce noeud est la racine
+        Node *parent;         // noeud parent, nullptr pour la racine
+        size_t nbElements;    // nombre d'éléments (de noeuds, hors multiensemble) dans
+        // le sous arbre dont ce noeud est la racine
 
-        Node(const_reference key)  // seul constructeur disponible. key est obligatoire
-                : key(key), right(nullptr), left(nullptr), nbElements(1) {
-            cout << "(C" << key << ") ";
+        template<typename... Args>
+        explicit Node(Args &&... args)  // la clé, obligatoire, est construite sur place à partir de args
+                : key(std::forward<Args>(args)...), right(nullptr), left(nullptr), parent(nullptr), nbElements(1) {
+            summarize(this);
+            Tracer::nodeCreated(this->key);
         }
 
         ~Node()               // destructeur
         {
-            cout << "(D" << key << ") ";
+            Tracer::nodeDestroyed(key);
         }
 
         Node() = delete;             // pas de construction par défaut
@@ -58,11 +583,150 @@ private:
         Node(Node &&) = delete;       // pas de construction par déplacement
     };
 
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeAllocTraits = std::allocator_traits<NodeAllocator>;
+
+    /**
+     *  @brief Pile utilisée par les parcours itératifs à la place de la pile d'appels.
+     *
+     *  Les Inline premiers éléments sont stockés dans l'objet lui-même, ce qui suffit
+     *  à tout arbre équilibré (un AVL de 2^64 noeuds a une hauteur inférieure à 93).
+     *  Au-delà (arbre dégénéré), les éléments sont placés dans un vecteur sur le tas.
+     */
+    template<typename U>
+    class NodeStack {
+    public:
+        NodeStack() : _size(0) {}
+
+        void push(U u) {
+            if (_size < Inline)
+                _inline[_size] = u;
+            else
+                _spill.push_back(u);
+            ++_size;
+        }
+
+        U pop() noexcept {
+            --_size;
+            if (_size < Inline)
+                return _inline[_size];
+            U u = _spill.back();
+            _spill.pop_back();
+            return u;
+        }
+
+        U top() const noexcept {
+            return _size <= Inline ? _inline[_size - 1] : _spill.back();
+        }
+
+        // la référence est invalidée par le push suivant
+        U &top() noexcept {
+            return _size <= Inline ? _inline[_size - 1] : _spill.back();
+        }
+
+        bool empty() const noexcept {
+            return _size == 0;
+        }
+
+        size_t size() const noexcept {
+            return _size;
+        }
+
+        // les push suivants n'allouent plus rien tant que la pile ne dépasse pas n éléments
+        void reserve(size_t n) {
+            if (n > Inline)
+                _spill.reserve(n - Inline);
+        }
+
+    private:
+        static const size_t Inline = 128;
+        U _inline[Inline];
+        std::vector<U> _spill;
+        size_t _size;
+    };
+
+    /**
+     *  @brief Vrai si Compare est transparent et compare K et T dans les deux sens
+     */
+    template<typename K>
+    struct IsLookupKey {
+        template<typename X, typename C>
+        static auto test(int) -> decltype(
+                std::declval<const C &>()(std::declval<const X &>(), std::declval<const value_type &>()),
+                std::declval<const C &>()(std::declval<const value_type &>(), std::declval<const X &>()),
+                std::declval<typename C::is_transparent *>(), std::true_type());
+
+        template<typename, typename>
+        static std::false_type test(...);
+
+        static const bool value = decltype(test<K, Compare>(0))::value;
+    };
+
+    /**
+     *  @brief Active les recherches hétérogènes pour les clés K autres que T
+     */
+    template<typename K>
+    using EnableIfLookup = typename std::enable_if<
+            !std::is_same<typename std::decay<K>::type, value_type>::value and IsLookupKey<K>::value>::type;
+
+    template<typename A, typename B>
+    bool less(const A &a, const B &b) const {
+        countEvent(&CounterStore::comparisons);
+        return _comp(a, b);
+    }
+
+    // < 0 si a est avant b, 0 si elles sont équivalentes, > 0 sinon. Un seul appel par noeud
+    template<typename A, typename B>
+    int compare(const A &a, const B &b) const {
+        countEvent(&CounterStore::comparisons);
+        return compareThreeWay(_comp, a, b);
+    }
+
+    /**
+     *  @brief Compteurs d'évènements, partagés par tous les arbres de ce type.
+     *         Ils n'existent que si BST_COUNTERS est défini à la compilation.
+     */
+    struct CounterStore {
+        std::atomic<size_t> comparisons;
+        std::atomic<size_t> allocations;
+        std::atomic<size_t> deallocations;
+        std::atomic<size_t> rotations;
+        std::atomic<size_t> rebuilds;
+    };
+
+#ifdef BST_COUNTERS
+    static CounterStore &counterStore() noexcept {
+        static CounterStore store{{0}, {0}, {0}, {0}, {0}};
+        return store;
+    }
+
+    static void countEvent(std::atomic<size_t> CounterStore::*counter, size_t n = 1) noexcept {
+        (counterStore().*counter).fetch_add(n, std::memory_order_relaxed);
+    }
+#else
+    static void countEvent(std::atomic<size_t> CounterStore::*, size_t = 1) noexcept {}
+#endif
+
     /**
      *  @brief  Racine de l'arbre. nullptr si l'arbre est vide
      */
     Node *_root;
 
+    /**
+     *  @brief  Allocateur utilisé pour tous les noeuds de l'arbre
+     */
+    NodeAllocator _alloc;
+
+    /**
+     *  @brief  Etat de la politique d'équilibrage (paramètres et statistiques de ScapegoatBalance)
+     */
+    Balance _balance;
+
+    /**
+     *  @brief  Comparateur des clés
+     */
+    Compare _comp;
+
 public:
 
     /**
@@ -73,27 +737,135 @@ public:
         // Nothing to do...
     }
 
+    /**
+     *  @brief Construit un arbre vide utilisant l'allocateur donné
+     *  @param alloc l'allocateur (reconverti pour allouer des noeuds)
+     *  @remark Complexité : O(1)
+     */
+    explicit BinarySearchTree(const Allocator &alloc) : _root(nullptr), _alloc(alloc) {
+        // Nothing to do...
+    }
+
+    /**
+     *  @brief Construit un arbre vide ordonné par comp
+     *  @param comp le comparateur des clés
+     *  @param alloc l'allocateur à utiliser
+     *  @remark Complexité : O(1)
+     */
+    explicit BinarySearchTree(const Compare &comp, const Allocator &alloc = Allocator())
+            : _root(nullptr), _alloc(alloc), _comp(comp) {
+        // Nothing to do...
+    }
+
+    key_compare key_comp() const {
+        return _comp;
+    }
+
     /**
      *  @brief Constucteur de copie.
      *
+     *  La structure de other est reproduite telle quelle, sans réinsérer les clés
+     *
      *  @param other le BinarySearchTree à copier
      *  @remark Complexité : O(n)
      */
-    BinarySearchTree(const BinarySearchTree &other) : BinarySearchTree() {
-        copy(other._root);
+    BinarySearchTree(const BinarySearchTree &other)
+            : _root(nullptr), _alloc(NodeAllocTraits::select_on_container_copy_construction(other._alloc)),
+              _balance(other._balance), _comp(other._comp) {
+        try {
+            cloneSubTree(other._root, _root);
+        } catch (...) {
+            deleteSubTree(_root);
+            throw;
+        }
+    }
+
+    /**
+     *  @brief Construit un arbre équilibré à partir des clés d'une séquence
+     *
+     *  @param first début de la séquence
+     *  @param last fin de la séquence
+     *  @param alloc l'allocateur à utiliser
+     *  @remark Complexité : O(n) si la séquence est triée, O(n log(n)) sinon
+     *  @see bulkLoad
+     */
+    template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    BinarySearchTree(InputIt first, InputIt last, const Allocator &alloc = Allocator())
+            : _root(nullptr), _alloc(alloc) {
+        bulkLoad(first, last);
+    }
+
+    /**
+     *  @brief Remplace le contenu de l'arbre par les clés d'une séquence
+     *
+     *  Les noeuds sont créés dans l'ordre de lecture et chaînés en liste, sans
+     *  copie intermédiaire des clés. Une séquence croissante (les doublons
+     *  consécutifs sont ignorés) est arborisée directement en un arbre parfaitement
+     *  équilibré. Sinon les noeuds sont d'abord triés et dédoublonnés, en gardant
+     *  la première occurrence de chaque clé comme le ferait insert. En
+     *  multiensemble, les doublons s'ajoutent aux occurrences de leur clé.
+     *
+     *  @param first début de la séquence
+     *  @param last fin de la séquence
+     *  @exception si une exception survient, l'arbre n'est pas modifié
+     *  @remark Complexité : O(n) si la séquence est triée, O(n log(n)) sinon
+     */
+    template<typename InputIt>
+    void bulkLoad(InputIt first, InputIt last) {
+        Node *list = nullptr;
+        Node **tail = &list;
+        Node *prev = nullptr;
+        size_t cnt = 0;
+        bool sorted = true;
+
+        try {
+            for (; first != last; ++first) {
+                // Une séquence de temporaires (move_iterator, ...) est déplacée dans les noeuds
+                auto &&key = *first;
+                if (prev != nullptr and !less(prev->key, key)) {
+                    // Doublon consécutif, déjà présent dans la liste
+                    if (!less(key, prev->key)) {
+                        setMultiplicity(prev, multiplicity(prev) + 1);
+                        continue;
+                    }
+                    sorted = false;
+                }
+                prev = createNode(std::forward<decltype(key)>(key));
+                *tail = prev;
+                tail = &prev->right;
+                ++cnt;
+            }
+            if (!sorted)
+                sortList(list, cnt);
+        } catch (...) {
+            deleteSubTree(list);
+            throw;
+        }
+
+        deleteSubTree(_root);
+        arborize(_root, list, cnt);
     }
 
     /**
      * @brief Copie les noeauds d'un arbre ds l'objet courrant
      *
+     * Parcours pré-ordonné itératif, les noeuds restant à copier sont empilés
+     *
      * @param N noeaud racine a copier
      * @remark Complexité : O(n)
      */
     void copy(const Node *N) {
-        if (N) {
-            insert(N->key);
-            copy(N->left);
-            copy(N->right);
+        NodeStack<const Node *> stack;
+        if (N)
+            stack.push(N);
+        while (!stack.empty()) {
+            const Node *r = stack.pop();
+            insert(r->key);
+            // Le sous arbre droit est empilé en premier pour copier le gauche d'abord
+            if (r->right)
+                stack.push(r->right);
+            if (r->left)
+                stack.push(r->left);
         }
     }
 
@@ -105,10 +877,15 @@ public:
      */
     BinarySearchTree &operator=(const BinarySearchTree &other) {
         // Si on essaye de faire une affectation entre 2 objet qui sont au meme emplacement mémoire -> retourne l'objet
-        if (this->_root == other._root)
+        // (deux arbres vides ont la même racine nulle, mais pas le même comparateur, allocateur ou équilibrage)
+        if (this == &other)
             return *this;
-        // Appel le constructeur de copie dans un objet temp, et swap l'objet courant avec le temp
-        BinarySearchTree tmpTree(other);
+        // Copie dans un objet temp, et swap l'objet courant avec le temp. Contrairement au constructeur
+        // de copie, l'allocateur de other est adopté si l'allocateur le demande (PoolAllocator)
+        BinarySearchTree tmpTree(other._comp, NodeAllocTraits::propagate_on_container_copy_assignment::value
+                                              ? other._alloc : this->_alloc);
+        tmpTree._balance = other._balance;
+        cloneSubTree(other._root, tmpTree._root);
         swap(tmpTree);
 
         return *this;
@@ -124,6 +901,10 @@ public:
         Node *root = this->_root;
         this->_root = other._root;
         other._root = root;
+        // Les noeuds restent liés à l'allocateur qui les a créés
+        std::swap(this->_alloc, other._alloc);
+        std::swap(this->_balance, other._balance);
+        std::swap(this->_comp, other._comp);
     }
 
     /**
@@ -132,7 +913,8 @@ public:
      *  @param other le BST dont on vole le contenu
      *  @remark Complexité : O(n)
      */
-    BinarySearchTree(BinarySearchTree &&other) noexcept : BinarySearchTree() {
+    BinarySearchTree(BinarySearchTree &&other) noexcept
+            : _root(nullptr), _alloc(other._alloc), _balance(other._balance), _comp(other._comp) {
         // Utilise l'opérateur d'affectation par copie créé aupréalable et met a null l'objet en parametre apres avoir été copié
         this->_root = other._root;
         other._root = nullptr;
@@ -146,7 +928,8 @@ public:
      */
     BinarySearchTree &operator=(BinarySearchTree &&other) noexcept {
         // Si on essaye de faire une affectation entre 2 objet qui sont au meme emplacement mémoire -> retourne l'objet
-        if (this->_root == other._root)
+        // (deux arbres vides ont la même racine nulle, mais pas le même comparateur, allocateur ou équilibrage)
+        if (this == &other)
             return *this;
 
         // On swap l'objet en param avec l'objet courant
@@ -159,7 +942,7 @@ public:
     // @brief Destructeur
     //
     // Ne pas modifier mais écrire la fonction
-    // récursive privée deleteSubTree(Node*)
+    // privée deleteSubTree(Node*)
     // @remark Complexité : O(n)
     //
     ~BinarySearchTree() {
@@ -175,34 +958,185 @@ private:
     //          peut éventuellement valoir nullptr
     // @remark Complexité : O(n)
     //
-    static void deleteSubTree(Node *r) noexcept {
-        // On va d'abord dans tous les noeud de gauche (si pas une feuille)
-        if (r->left != nullptr) {
-            deleteSubTree(r->left);
-        }
-        // La on a fini pour le coté gauche, on va donc dans le coté droit (si pas une feuille)
-        if (r->right != nullptr) {
-            deleteSubTree(r->right);
+    void deleteSubTree(Node *r) noexcept {
+        while (r != nullptr) {
+            // Tant que le noeud a un enfant gauche, on le remonte par une rotation à droite :
+            // l'arbre devient peu à peu une liste chainée par la droite, sans pile
+            if (r->left != nullptr) {
+                Node *l = r->left;
+                r->left = l->right;
+                l->right = r;
+                r = l;
+            }
+            // Plus d'enfant gauche, on peut donc supprimer le noeud et passer à la suite
+            else {
+                Node *next = r->right;
+                destroyNode(r);
+                r = next;
+            }
         }
+    }
 
-        // A ce moment on a une feuille, on peut donc supprimer le noeud
-        r->~Node();
+    /**
+     * @brief Alloue et construit un nouveau noeud
+     * @param args les arguments du constructeur de la clé du noeud
+     * @return le noeud créé, sans enfant
+     * @remark Complexité : O(1)
+     */
+    template<typename... Args>
+    Node *createNode(Args &&... args) {
+        Node *n = NodeAllocTraits::allocate(_alloc, 1);
+        countEvent(&CounterStore::allocations);
+        try {
+            NodeAllocTraits::construct(_alloc, n, std::forward<Args>(args)...);
+        } catch (...) {
+            NodeAllocTraits::deallocate(_alloc, n, 1);
+            throw;
+        }
+        return n;
     }
 
-public:
-    //
+    /**
+     * @brief Reproduit un sous arbre, avec ses compteurs et ses données d'équilibrage
+     *
+     * Parcours pré-ordonné sans pile : on redescend dans la copie en parallèle de
+     * l'original et on remonte par les liens vers les parents.
+     *
+     * @param src la racine du sous arbre à copier, peut valoir nullptr
+     * @param dst le lien où écrire la copie. En cas d'exception, il contient
+     *            la partie déjà copiée, qui reste un arbre valide à détruire
+     * @remark Complexité : O(n)
+     */
+    void cloneSubTree(const Node *src, Node *&dst) {
+        dst = nullptr;
+        if (src == nullptr)
+            return;
+
+        dst = cloneNode(src, nullptr);
+        const Node *s = src;
+        Node *d = dst;
+        while (true) {
+            if (s->left != nullptr and d->left == nullptr) {
+                d->left = cloneNode(s->left, d);
+                s = s->left;
+                d = d->left;
+            } else if (s->right != nullptr and d->right == nullptr) {
+                d->right = cloneNode(s->right, d);
+                s = s->right;
+                d = d->right;
+            } else if (s == src) {
+                return;
+            } else {
+                s = s->parent;
+                d = d->parent;
+            }
+        }
+    }
+
+    /**
+     * @brief Copie un noeud seul, sans ses enfants
+     * @param src le noeud à copier
+     * @param parent le parent de la copie
+     * @remark Complexité : O(1)
+     */
+    Node *cloneNode(const Node *src, Node *parent) {
+        Node *n = createNode(src->key);
+        n->parent = parent;
+        n->nbElements = src->nbElements;
+        static_cast<typename Balance::NodeData &>(*n) = static_cast<const typename Balance::NodeData &>(*src);
+        static_cast<typename Augment::NodeData &>(*n) = static_cast<const typename Augment::NodeData &>(*src);
+        static_cast<typename Keys::NodeData &>(*n) = static_cast<const typename Keys::NodeData &>(*src);
+        return n;
+    }
+
+    /**
+     * @brief Trie une liste de noeuds chaînés par la droite et en retire les doublons,
+     *        dont les occurrences s'ajoutent à celles du premier en multiensemble
+     * @param list la tête de la liste, modifiée pour pointer vers la plus petite clé
+     * @param cnt le nombre de noeuds de la liste, mis à jour
+     * @remark Complexité : O(n log(n))
+     */
+    void sortList(Node *&list, size_t &cnt) {
+        std::vector<Node *> nodes;
+        nodes.reserve(cnt);
+        for (Node *n = list; n != nullptr; n = n->right)
+            nodes.push_back(n);
+
+        // Tri stable : parmi des clés égales, la première lue reste en tête
+        std::stable_sort(nodes.begin(), nodes.end(), [this](const Node *a, const Node *b) {
+            return less(a->key, b->key);
+        });
+
+        Node **tail = &list;
+        Node *prev = nullptr;
+        cnt = 0;
+        for (Node *n : nodes) {
+            if (prev != nullptr and !less(prev->key, n->key)) {
+                setMultiplicity(prev, multiplicity(prev) + multiplicity(n));
+                destroyNode(n);
+                continue;
+            }
+            *tail = n;
+            tail = &n->right;
+            prev = n;
+            ++cnt;
+        }
+        *tail = nullptr;
+    }
+
+    /**
+     * @brief Détruit un noeud et rend sa mémoire à l'allocateur
+     * @param n le noeud à détruire, ses enfants ne sont pas touchés
+     * @remark Complexité : O(1)
+     */
+    void destroyNode(Node *n) noexcept {
+        countEvent(&CounterStore::deallocations);
+        NodeAllocTraits::destroy(_alloc, n);
+        NodeAllocTraits::deallocate(_alloc, n, 1);
+    }
+
+public:
+    //
     // @brief Insertion d'une cle dans l'arbre
     //
     // @param key la clé à insérer.
     //
     // Ne pas modifier mais écrire la fonction
-    // récursive privée insert(Node*&,const_reference)
+    // privée insert(Node*&,const_reference)
     // @remark Complexité moyenne : O(log(n))
     //
     void insert(const_reference key) {
         insert(_root, key);
     }
 
+    //
+    // @brief Insertion d'une cle temporaire, déplacée dans son noeud
+    //
+    // @param key la clé à insérer. Elle n'est déplacée que si elle est insérée
+    // @remark Complexité moyenne : O(log(n))
+    //
+    void insert(value_type &&key) {
+        insert(_root, std::move(key));
+    }
+
+    //
+    // @brief Insertion d'une cle construite sur place
+    //
+    // @param args les arguments du constructeur de la clé
+    // @return vrai si la cle est inseree. faux si elle etait deja presente, le
+    //         noeud construit est alors détruit. En multiensemble, toujours vrai :
+    //         une clé présente gagne une occurrence, et le noeud construit est détruit
+    // @remark Complexité moyenne : O(log(n))
+    //
+    template<typename... Args>
+    bool emplace(Args &&... args) {
+        Node *n = createNode(std::forward<Args>(args)...);
+        std::pair<Node *, bool> inserted = insert(_root, n->key, [n] { return n; }, IsMultiset);
+        if (inserted.first != n)
+            destroyNode(n);
+        return inserted.second;
+    }
+
 private:
     //
     // @brief Insertion d'une cle dans un sous-arbre
@@ -213,39 +1147,62 @@ private:
     //
     // @return vrai si la cle est inseree. faux si elle etait deja presente.
     //
-    // Si la cle est deja presente, cette fonction ne fait rien.
+    // Si la cle est deja presente, cette fonction ne fait rien, sauf en
+    // multiensemble où elle en ajoute une occurrence (et retourne vrai).
     // x peut éventuellement valoir nullptr en entrée.
     // la fonction peut modifier x, reçu par référence, si nécessaire
     //
     // @remark Complexité moyenne : O(log(n))
     //
-    static bool insert(Node *&r, const_reference key) {
-        // Cas triviale : On a atteint une feuille, on peut créer le nouveau noeud
-        if (r == nullptr) {
-            r = new Node{key};
-            return true;
-        }
+    template<typename K>
+    bool insert(Node *&r, K &&key) {
+        return insert(r, key, [&] { return createNode(std::forward<K>(key)); }, IsMultiset).second;
+    }
 
-        // On va d'abord dans le sous-arbre gauche (clé à ajouter plus petite que la clé du noeud)
-        else if (key < r->key) {
+    //
+    // @brief Insertion dans un sous-arbre d'un noeud fourni par make
+    //
+    // @param key la clé qui guide la descente
+    // @param make appelée une seule fois, si la clé est absente, pour obtenir le
+    //             noeud à accrocher. Si elle lève une exception, l'arbre n'est pas modifié
+    // @param addCopy si vrai, une clé présente gagne une occurrence (multiensemble)
+    // @return le noeud de la clé et vrai si elle vient d'être insérée
+    //
+    template<typename K, typename Make>
+    std::pair<Node *, bool> insert(Node *&r, const K &key, Make make, bool addCopy = false) {
+        Node **link = &r;
+        Node *parent = nullptr;
 
-            if (insert(r->left, key)) {
-                // incrément du nb élément si on a bien inséré une nouvelle clé
-                ++r->nbElements;
-                return true;
+        // On descend jusqu'à une feuille, le chemin sera remonté par les parents
+        while (*link != nullptr) {
+            int c = compare(key, (*link)->key);
+            // On va dans le sous-arbre gauche (clé à ajouter plus petite que la clé du noeud)
+            if (c < 0) {
+                parent = *link;
+                link = &(*link)->left;
             }
-
-        }
-        // Ensuite on va dans le sous-arbre droite (clé à ajouter plus grande que la clé du noeud)
-        else if (key > r->key) {
-            if (insert(r->right, key)) {
-                // incrément du nb élément si on a bien inséré une nouvelle clé
-                ++r->nbElements;
-                return true;
+            // Sinon dans le sous-arbre droite (clé à ajouter plus grande que la clé du noeud)
+            else if (c > 0) {
+                parent = *link;
+                link = &(*link)->right;
+            }
+            // Sinon la clé existe déjà !
+            else {
+                if (addCopy)
+                    addCopies(*link, 1);
+                return std::make_pair(*link, addCopy);
             }
         }
-        // Sinon la clé existe déjà !
-        return false;
+
+        // On a atteint une feuille, on peut créer le nouveau noeud
+        Node *created = make();
+        *link = created;
+        created->parent = parent;
+
+        // mise à jour du nb élément de chaque ancêtre en remontant le chemin
+        retrace(parent, r);
+        rebuildUnbalanced(parent, nullptr, _balance);
+        return std::make_pair(created, true);
     }
 
 public:
@@ -257,13 +1214,41 @@ public:
     // @return vrai si la cle trouvee, faux sinon.
     //
     // Ne pas modifier mais écrire la fonction
-    // récursive privée contains(Node*,const_reference)
+    // privée contains(Node*,const_reference)
     // @remark Complexité moyenne : O(log(n))
     //
     bool contains(const_reference key) const noexcept {
         return contains(_root, key);
     }
 
+    //
+    // @brief Recherche hétérogène : key n'est pas un T mais se compare à T avec <
+    //        dans les deux sens. Aucun T temporaire n'est construit.
+    //
+    template<typename K, typename = EnableIfLookup<K>>
+    bool contains(const K &key) const noexcept {
+        return contains(_root, key);
+    }
+
+    //
+    // @brief Nombre d'occurrences d'une cle
+    //
+    // @return 0 si la cle est absente, 1 si elle est présente, ou sa
+    //         multiplicité en multiensemble
+    // @remark Complexité moyenne : O(log(n))
+    //
+    size_t count(const_reference key) const noexcept {
+        Node *n = findNode(_root, key);
+        return n != nullptr ? multiplicity(n) : 0;
+    }
+
+    // recherche hétérogène, voir contains
+    template<typename K, typename = EnableIfLookup<K>>
+    size_t count(const K &key) const noexcept {
+        Node *n = findNode(_root, key);
+        return n != nullptr ? multiplicity(n) : 0;
+    }
+
 private:
     //
     // @brief Recherche d'une cle dans un sous-arbre
@@ -274,23 +1259,21 @@ private:
     // @return vrai si la cle trouvee, faux sinon.
     // @remark Complexité moyenne : O(log(n)
     //
-    static bool contains(Node *r, const_reference key) noexcept {
-        // Cas trivial
-        if (r == nullptr) {
-            return false;
-        }
-        // si la clé cherchée est plus petite que la clé du noeud en cours, on va rechercher dans le ss-arbre gauche
-        else if (key < r->key) {
-            contains(r->left, key);
-        }
-        // si la clé cherchée est plus grande que la clé du noeud en cours, on va rechercher dans le ss-arbre droit
-        else if (key > r->key) {
-            contains(r->right, key);
-        }
-        // si pas nullptr, pas plus petite ou plus grande, on l'a trouvée
-        else {
-            return true;
+    template<typename K>
+    bool contains(Node *r, const K &key) const noexcept {
+        while (r != nullptr) {
+            int c = compare(key, r->key);
+            // si la clé cherchée est plus petite que la clé du noeud en cours, on va rechercher dans le ss-arbre gauche
+            if (c < 0)
+                r = r->left;
+            // si la clé cherchée est plus grande que la clé du noeud en cours, on va rechercher dans le ss-arbre droit
+            else if (c > 0)
+                r = r->right;
+            // si pas plus petite ou plus grande, on l'a trouvée
+            else
+                return true;
         }
+        return false;
     }
 
 public:
@@ -328,6 +1311,8 @@ public:
         }
 
         deleteMin(_root);
+        // Seule la branche gauche a changé
+        rebuildUnbalanced(nullptr, &_root, _balance);
     }
 
 
@@ -341,12 +1326,18 @@ public:
     // retourne vrai
     //
     // Ne pas modifier mais écrire la fonction
-    // récursive privée deleteElement(Node*&,const_reference)
+    // privée deleteElement(Node*&,const_reference)
     //
     bool deleteElement(const_reference key) noexcept {
         return deleteElement(_root, key);
     }
 
+    // recherche hétérogène, voir contains
+    template<typename K, typename = EnableIfLookup<K>>
+    bool deleteElement(const K &key) noexcept {
+        return deleteElement(_root, key);
+    }
+
 private:
 
     //
@@ -357,38 +1348,58 @@ private:
     //
     static const_reference min(Node *r) {
         // La clé min est forcément le dernier noeud du sous-arbre gauche
-        if (r->left != nullptr) {
-            min(r->left);
-        } else {
-            return r->key;
-        }
+        while (r->left != nullptr)
+            r = r->left;
+        return r->key;
     }
 
     //
     // @brief Supprime le plus petit element de l'arbre.
     // @param r La racine du sous arbre
+    //
+    // En multiensemble, seule une occurrence de la plus petite clé est retirée :
+    // son noeud n'est détruit qu'avec la dernière.
     // @remark Complexité moyenne : O(log(n))
     //
-    static void deleteMin(Node *&r) {
-        // Appel récursif tant qu'on a pas le noeud avec la clé min (dernier noeud a gauche)
-        if (r->left != nullptr) {
-            deleteMin(r->left);
-            // Décrément du nbElement en remontant les appels récursif, pour la mise a jour
-            --r->nbElements;
-        }
-        // Ici, le noeud est celui qui a la clé la plus petite
-        else {
-            // On détruit le noeud
-            r->~Node();
-            // Si le noeud a un enfant droit, celui-ci prend ca place
-            if (r->right != nullptr) {
-                r = r->right;
-            }
-            // Si le noeud avec la clé min est une feuille, on le met a nullptr
-            else {
-                r = nullptr;
+    void deleteMin(Node *&r) {
+        if (IsMultiset) {
+            Node *minNode = chercherMinNode(r);
+            if (multiplicity(minNode) > 1) {
+                addCopies(minNode, -1);
+                return;
             }
         }
+        destroyNode(detachMin(r));
+    }
+
+    //
+    // @brief Détache le plus petit element du sous arbre, sans le détruire.
+    // @param r La racine du sous arbre, ne peut pas valoir nullptr
+    // @return le noeud détaché, sans enfant ni parent
+    // @remark Complexité moyenne : O(log(n))
+    //
+    static Node *detachMin(Node *&r) noexcept {
+        // On descend jusqu'au noeud avec la clé min (dernier noeud a gauche)
+        Node **link = &r;
+        Node *parent = nullptr;
+        while ((*link)->left != nullptr) {
+            parent = *link;
+            link = &(*link)->left;
+        }
+
+        // Ici, le noeud est celui qui a la clé la plus petite, son enfant droit
+        // (éventuellement nullptr) prend sa place
+        Node *old = *link;
+        *link = old->right;
+        setParent(old->right, old->parent);
+
+        // Décrément du nbElement en remontant le chemin, pour la mise a jour
+        retrace(parent, r);
+
+        old->right = nullptr;
+        old->parent = nullptr;
+        update(old);
+        return old;
     }
 
     //
@@ -402,52 +1413,97 @@ private:
     // retourne vrai
     // @remark Complexité moyenne : O(log(n))
     //
-    static bool deleteElement(Node *&r, const_reference key) noexcept {
-        // Cas triviale, clé pas trouvée
-        if (r == nullptr) {
-            return false;
-        }
+    template<typename K>
+    bool deleteElement(Node *&r, const K &key) noexcept {
+        // Le chemin n'est pas mémorisé : il est remonté par les parents, sans
+        // allocation même dans un arbre dégénéré
+        Node **link = &r;
+        Node *parent = nullptr;
 
-        // Besoin de recherché dans le sous arbre de gauche
-        if (key < r->key) {
-            if (deleteElement(r->left, key)) {
-                // Si on a supprimé un noeud, on va décrémenter le nbElement du noeud courant pour le mettre à jour
-                --r->nbElements;
-                return true;
-            }
-        }
-        // Besoin de recherché dans le sous arbre de gauche
-        else if (key > r->key) {
-            if (deleteElement(r->right, key)) {
-                // Si on a supprimé un noeud, on va décrémenter le nbElement du noeud courant pour le mettre à jour
-                --r->nbElements;
-                return true;
+        while (true) {
+            // Cas triviale, clé pas trouvée
+            if (*link == nullptr)
+                return false;
+
+            int c = compare(key, (*link)->key);
+            // Besoin de recherché dans le sous arbre de gauche
+            if (c < 0) {
+                parent = *link;
+                link = &(*link)->left;
             }
-        }
-        // Clé trouvée
-        else {
-            // on va décrémenter le nbElement du noeud courant pour le mettre à jour
-            --r->nbElements;
-            // Cas simple, on a un des deux enfants null, on detruit le noeud courant et l'enfant prend la place du noeud courant
-            if (r->left == nullptr) {
-                r->~Node();
-                r = r->right;
-            } else if (r->right == nullptr) {
-                r->~Node();
-                r = r->left;
+            // Besoin de recherché dans le sous arbre de droite
+            else if (c > 0) {
+                parent = *link;
+                link = &(*link)->right;
             }
-            // Cas compliqué (on a les deux enfants) on utilise la technique de Hibbard
+            // Clé trouvée
             else {
-                // Appel une métode qui nous retourne un ptr référence sur le noeud le plus petit du ss-arbre droit
-                // Call a method to fetch the minimum node of the right subtree
-                Node *&minNode = chercherMinNode(r->right);
-                // On swap le noeud courant et le noeud le plus petit du ss arbre droite
-                swapNodes(r, minNode);
-                // On supprime l'élément minimum du ss arbre droit (celui qu on vient d'etre swap, donc celui qu on veut)
-                deleteMin(r->right);
+                break;
             }
+        }
+
+        Node *found = *link;
+        // En multiensemble, on retire une seule occurrence : le noeud reste tant qu'il en a
+        if (multiplicity(found) > 1) {
+            addCopies(found, -1);
             return true;
         }
+        // Cas simple, on a un des deux enfants null, on detruit le noeud courant et l'enfant prend la place du noeud courant
+        if (found->left == nullptr) {
+            *link = found->right;
+            setParent(found->right, found->parent);
+            destroyNode(found);
+        } else if (found->right == nullptr) {
+            *link = found->left;
+            setParent(found->left, found->parent);
+            destroyNode(found);
+        }
+        // Cas compliqué (on a les deux enfants) on utilise la technique de Hibbard
+        else {
+            // on va décrémenter le nbElement du noeud courant pour le mettre à jour
+            --found->nbElements;
+            // Appel une métode qui nous retourne un ptr référence sur le noeud le plus petit du ss-arbre droit
+            Node *&minNode = chercherMinNode(found->right);
+            // On swap le noeud courant et le noeud le plus petit du ss arbre droite
+            swapNodes(*link, minNode);
+            // On supprime l'élément minimum du ss arbre droit (celui qu on vient d'etre swap, donc celui qu on veut)
+            deleteMin((*link)->right);
+            update(*link);
+            rebalance(*link);
+        }
+
+        // Si on a supprimé un noeud, on va décrémenter le nbElement des ancêtres pour les mettre à jour
+        retrace(parent, r);
+        // Sous les ancêtres, le remplaçant et la branche gauche de son sous arbre droit ont aussi changé
+        if (*link != nullptr)
+            rebuildUnbalanced(*link, &(*link)->right, _balance);
+        else
+            rebuildUnbalanced(parent, nullptr, _balance);
+        return true;
+    }
+
+    /**
+     * @brief Met à jour un noeud et ses ancêtres après une insertion ou une suppression
+     *
+     * nbElements est recalculé plutôt que décrémenté : en multiensemble, le
+     * noeud supprimé n'est pas toujours celui dont les occurrences ont disparu
+     * (Hibbard remonte le successeur avec les siennes). Le chemin est remonté par
+     * les parents : aucune mémoire n'est allouée, même dans un arbre dégénéré.
+     *
+     * @param n Le premier noeud à mettre à jour, nullptr pour aucun. Il doit être dans le sous arbre r
+     * @param r La racine du sous arbre, dernier noeud mis à jour. Peut être remplacée par une rotation
+     * @remark Complexité : O(profondeur de n)
+     */
+    static void retrace(Node *n, Node *&r) noexcept {
+        while (n != nullptr) {
+            bool top = n == r;
+            Node *&link = top ? r : n->parent->left == n ? n->parent->left : n->parent->right;
+            update(link);
+            rebalance(link);
+            if (top)
+                return;
+            n = link->parent;
+        }
     }
 
     /**
@@ -457,10 +1513,34 @@ private:
      * @remark Complexité : O(1)
      */
     static void swapNodes(Node *&a, Node *&b) {
-        std::swap(a->left, b->left);
-        std::swap(a->right, b->right);
-        std::swap(a->nbElements, b->nbElements);
-        std::swap(a, b);
+        Node *na = a, *nb = b;
+        Node *parentA = na->parent, *parentB = nb->parent;
+        std::swap(na->left, nb->left);
+        std::swap(na->right, nb->right);
+        std::swap(na->nbElements, nb->nbElements);
+        std::swap(static_cast<typename Balance::NodeData &>(*na), static_cast<typename Balance::NodeData &>(*nb));
+        std::swap(static_cast<typename Augment::NodeData &>(*na), static_cast<typename Augment::NodeData &>(*nb));
+
+        // Si b était l'enfant direct de a, l'échange des liens l'a fait pointer sur lui-même
+        if (nb->right == nb) {
+            nb->right = na;
+            a = nb;
+            parentB = nb;
+        } else if (nb->left == nb) {
+            nb->left = na;
+            a = nb;
+            parentB = nb;
+        } else {
+            std::swap(a, b);
+        }
+
+        // Mise à jour des liens vers les parents
+        nb->parent = parentA;
+        na->parent = parentB;
+        setParent(na->left, na);
+        setParent(na->right, na);
+        setParent(nb->left, nb);
+        setParent(nb->right, nb);
     }
 
     /**
@@ -470,315 +1550,2500 @@ private:
      * @remark Complexité moyenne : O(log(n))
      */
     static Node *&chercherMinNode(Node *&r) {
-        if (r->left != nullptr) {
-            chercherMinNode(r->left);
-        }
-        else {
-            return r;
-        }
+        Node **link = &r;
+        while ((*link)->left != nullptr)
+            link = &(*link)->left;
+        return *link;
     }
 
-public:
-    //
-    // @brief taille de l'arbre
-    //
-    // @return le nombre d'elements de l'arbre
-    // @remark Complexité : O(1)
-    //
-    size_t size() const noexcept {
-        return _root->nbElements;
+    /**
+     * @brief Nombre d'éléments d'un sous arbre
+     * @param r La racine du sous arbre, peut valoir nullptr
+     * @return r->nbElements, 0 si le sous arbre est vide
+     * @remark Complexité : O(1)
+     */
+    static size_t subtreeSize(const Node *r) noexcept {
+        return r != nullptr ? r->nbElements : 0;
     }
 
-    //
-    // @brief cle en position n
-    //
-    // @return une reference a la cle en position n par ordre croissant des
-    // elements
-    //
-    // @exception std::logic_error si nécessaire
-    //
-    // ajoutez le code de gestion des exceptions, puis mettez en oeuvre
-    // la fonction recursive nth_element(Node*, n)
-    // @remark Complexité : O(log(n))
-    //
-    const_reference nth_element(size_t n) const {
-
-        // gestion des exceptions
-        if (_root == nullptr)
-            throw std::logic_error("Il n'y a aucun éléments dans l'arbre!");
-        if (n > size())
-            throw std::logic_error("Index trop grand");
+    /**
+     * @brief Rattache un enfant à son parent
+     * @param child L'enfant, peut valoir nullptr
+     * @param parent Le nouveau parent de child
+     * @remark Complexité : O(1)
+     */
+    static void setParent(Node *child, Node *parent) noexcept {
+        if (child != nullptr)
+            child->parent = parent;
+    }
 
-        return nth_element(_root, n);
+    /**
+     * @brief Hauteur d'un sous arbre maintenue par la politique AVL
+     * @param r La racine du sous arbre, peut valoir nullptr
+     * @remark Complexité : O(1)
+     */
+    static unsigned avlHeight(const Node *r) noexcept {
+        return r != nullptr ? r->height : 0;
     }
 
-private:
+    /**
+     * @brief Recalcule les données d'équilibrage d'un noeud à partir de celles de ses enfants
+     * @param r Le noeud à mettre à jour, ses enfants doivent être à jour
+     * @remark Complexité : O(1)
+     */
+    static void refresh(Node *, NoBalance) noexcept {}
 
-    // @brief cle en position n dans un sous arbre
-    //
-    // @param r la racine du sous arbre. ne peut pas etre nullptr
-    // @param n la position n
-    //
-    // @return une reference a la cle en position n par ordre croissant des
-    // elements
-    //
-    static const_reference nth_element(Node *r, size_t n) noexcept {
-        size_t leftCount = r->left != nullptr ? r->left->nbElements : 0;
+    static void refresh(Node *r, AVLBalance) noexcept {
+        r->height = 1 + std::max(avlHeight(r->left), avlHeight(r->right));
+    }
 
-        // si la position est égale au nombre d'éléments a gauche, on a trouvé notre Node
-        if (n == leftCount)
-            return r->key;
+    /**
+     * @brief Recalcule le résumé d'un noeud à partir de sa clé et de ceux de ses enfants
+     * @param r Le noeud à mettre à jour, ses enfants doivent être à jour
+     * @remark Complexité : O(1)
+     */
+    static void summarize(Node *r) {
+        summarize(r, Augment());
+    }
 
-        // check pour savoir si l'on doit chercher la valeur a gauche ou a droite de l'arbre
-        // si la position est plus petite que le nbre d'éléments a gauche, il faut aller a gauche
-        if (n < leftCount)
-            return nth_element(r->left, n);
+    static void summarize(Node *, NoAugment) noexcept {}
 
-        // si la position est plus grande que le nbre d'éléments a gauche, il faut aller a droite
-        //  et l'on soustrait le nbre d'élément a gauche à la position
-        if (n > leftCount)
-            return nth_element(r->right, n - leftCount - 1);
+    template<typename A>
+    static void summarize(Node *r, const A &) {
+        typename A::summary_type s = measureCopies<A>(r);
+        if (r->left != nullptr)
+            s = A::combine(r->left->summary, s);
+        if (r->right != nullptr)
+            s = A::combine(s, r->right->summary);
+        r->summary = s;
+    }
 
+    /**
+     * @brief Résumé des occurrences de la clé d'un noeud seul
+     *
+     * En multiensemble, la clé compte autant de fois qu'elle est présente :
+     * exponentiation rapide, O(log(multiplicité)) appels à combine.
+     */
+    template<typename A>
+    static typename A::summary_type measureCopies(const Node *r) {
+        typename A::summary_type s = A::measure(r->key);
+        size_t copies = multiplicity(r);
+        if (copies > 1) {
+            typename A::summary_type once = s;
+            size_t bit = 1;
+            while (bit <= copies / 2)
+                bit <<= 1;
+            for (bit >>= 1; bit != 0; bit >>= 1) {
+                s = A::combine(s, s);
+                if (copies & bit)
+                    s = A::combine(s, once);
+            }
+        }
+        return s;
     }
 
-public:
-    //
-    // @brief position d'une cle dans l'ordre croissant des elements de l'arbre
-    //
-    // @param key la cle dont on cherche le rang
-    //
-    // @return la position entre 0 et size()-1, size_t(-1) si la cle est absente
-    //
-    // Ne pas modifier mais écrire la fonction
-    // récursive privée rank(Node*,const_reference)
-    // @remark Complexité moyenne : O(log(n))
-    //
-    size_t rank(const_reference key) const noexcept {
-        return rank(_root, key);
+    /**
+     * @brief Recalcule nbElements, le résumé et les données d'équilibrage d'un noeud
+     * @param r Le noeud à mettre à jour, ses enfants doivent être à jour
+     * @remark Complexité : O(1)
+     */
+    static void update(Node *r) noexcept {
+        r->nbElements = multiplicity(r) + subtreeSize(r->left) + subtreeSize(r->right);
+        summarize(r);
+        refresh(r, Balance());
     }
 
-private:
-    //
-    // @brief position d'une cle dans l'ordre croissant des elements du sous-arbre
-    //
-    // @param key la cle dont on cherche le rang
-    // @param r la racine du sous arbre
-    //
-    // @return la position entre 0 et size()-1, size_t(-1) si la cle est absente
-    // @remark Complexité moyenne : O(log(n))
-    //
-    static size_t rank(Node *r, const_reference key) noexcept {
+    /**
+     * @brief Nombre d'occurrences de la clé d'un noeud, toujours 1 hors multiensemble
+     * @remark Complexité : O(1)
+     */
+    static size_t multiplicity(const Node *r) noexcept {
+        return multiplicity(r, Keys());
+    }
 
-        if (r == nullptr or !contains(r, key))
-            return size_t(-1);
+    static size_t multiplicity(const Node *, UniqueKeys) noexcept {
+        return 1;
+    }
 
-        size_t leftCount = r->left != nullptr ? r->left->nbElements : 0;
-        
-        if (key < r->key)
-            return rank(r->left, key);
+    static size_t multiplicity(const Node *r, MultipleKeys) noexcept {
+        return r->multiplicity;
+    }
 
-        if (key > r->key)
-            return rank(r->right, key) + leftCount + 1;
+    /**
+     * @brief Change le nombre d'occurrences de la clé d'un noeud (multiensemble seulement)
+     * @param r Le noeud, nbElements et le résumé sont à mettre à jour par l'appelant
+     * @remark Complexité : O(1)
+     */
+    static void setMultiplicity(Node *, size_t, UniqueKeys) noexcept {}
 
-        if (key == r->key)
-            return leftCount;
+    static void setMultiplicity(Node *r, size_t copies, MultipleKeys) noexcept {
+        r->multiplicity = copies;
+    }
 
-        return size_t(-1);
+    static void setMultiplicity(Node *r, size_t copies) noexcept {
+        setMultiplicity(r, copies, Keys());
     }
 
-public:
-    //
-    // @brief linearise l'arbre
-    //
-    // transforme l'arbre en une liste simplement chainee composee des memes
-    // noeuds que precedemment, mais dont les pointeurs left sont tous egaux
-    // a nullptr. Cette liste doit toujours respecter les conditions d'un
-    // arbre binaire de recherche
-    //
-    // Ne pas modifier cette fonction qui sert essentiellement a tester la
-    // fonction recursive linearize(Node*, Node*&, size_t&) utilisée par
-    // la methode publique arborize
-    //
-    // @remark Complexité : O(n)
-    //
-    void linearize() noexcept {
-        size_t cnt = 0;
-        Node *list = nullptr;
-        linearize(_root, list, cnt);
-        _root = list;
+    /**
+     * @brief Ajoute (ou retire) des occurrences de la clé d'un noeud de l'arbre
+     *
+     * La forme de l'arbre ne change pas : seuls nbElements et les résumés du noeud
+     * et de ses ancêtres sont mis à jour, en remontant par les parents.
+     *
+     * @param r Le noeud, sa multiplicité doit rester au moins 1
+     * @param copies Le nombre d'occurrences à ajouter, négatif pour en retirer
+     * @remark Complexité : O(profondeur de r)
+     */
+    static void addCopies(Node *r, ptrdiff_t copies) noexcept {
+        setMultiplicity(r, size_t(ptrdiff_t(multiplicity(r)) + copies));
+        for (; r != nullptr; r = r->parent)
+            update(r);
+    }
+
+    /**
+     * @brief Rotation à gauche : l'enfant droit de r prend sa place
+     * @param r La racine du sous arbre, doit avoir un enfant droit
+     * @remark Complexité : O(1)
+     */
+    static void rotateLeft(Node *&r) noexcept {
+        countEvent(&CounterStore::rotations);
+        Node *x = r->right;
+        r->right = x->left;
+        setParent(r->right, r);
+        x->left = r;
+        x->parent = r->parent;
+        r->parent = x;
+        update(r);
+        update(x);
+        r = x;
+    }
+
+    /**
+     * @brief Rotation à droite : l'enfant gauche de r prend sa place
+     * @param r La racine du sous arbre, doit avoir un enfant gauche
+     * @remark Complexité : O(1)
+     */
+    static void rotateRight(Node *&r) noexcept {
+        countEvent(&CounterStore::rotations);
+        Node *x = r->left;
+        r->left = x->right;
+        setParent(r->left, r);
+        x->right = r;
+        x->parent = r->parent;
+        r->parent = x;
+        update(r);
+        update(x);
+        r = x;
+    }
+
+    /**
+     * @brief Rééquilibre un sous arbre selon la politique choisie. Appelée en
+     *        remontant le chemin d'une insertion ou d'une suppression, quand les
+     *        sous arbres de r sont déjà équilibrés et que r->nbElements est à jour.
+     * @param r La racine du sous arbre, peut être remplacée par une rotation
+     * @remark Complexité : O(1)
+     */
+    static void rebalance(Node *&r) noexcept {
+        rebalance(r, Balance());
+    }
+
+    static void rebalance(Node *&, NoBalance) noexcept {}
+
+    static void rebalance(Node *&r, AVLBalance) noexcept {
+        refresh(r, AVLBalance());
+        int diff = int(avlHeight(r->left)) - int(avlHeight(r->right));
+
+        // Sous arbre gauche trop haut : rotation double si son poids est à droite
+        if (diff > 1) {
+            if (avlHeight(r->left->left) < avlHeight(r->left->right))
+                rotateLeft(r->left);
+            rotateRight(r);
+        }
+        // Sous arbre droit trop haut : rotation double si son poids est à gauche
+        else if (diff < -1) {
+            if (avlHeight(r->right->right) < avlHeight(r->right->left))
+                rotateRight(r->right);
+            rotateLeft(r);
+        }
+    }
+
+    //
+    // @brief Reconstruit le plus haut sous arbre déséquilibré d'un chemin modifié
+    //
+    // @param n le plus bas noeud modifié : le chemin va de la racine à n, remonté
+    //          par les parents. nullptr pour aucun
+    // @param spine si non nul, lien à partir duquel la branche gauche a aussi été
+    //              modifiée, examinée après le chemin
+    //
+    // Sans effet pour les politiques autres que ScapegoatBalance.
+    //
+    template<typename B>
+    void rebuildUnbalanced(Node *, Node **, const B &) noexcept {}
+
+    void rebuildUnbalanced(Node *n, Node **spine, ScapegoatBalance &policy) noexcept {
+        Node *highest = nullptr;
+        for (; n != nullptr; n = n->parent)
+            if (unbalanced(n, policy))
+                highest = n;
+        if (highest != nullptr) {
+            Node *parent = highest->parent;
+            rebuildIfUnbalanced(parent == nullptr ? _root : parent->left == highest ? parent->left : parent->right,
+                                policy);
+            return;
+        }
+        for (Node **link = spine; link != nullptr and *link != nullptr; link = &(*link)->left)
+            if (rebuildIfUnbalanced(*link, policy))
+                return;
+    }
+
+    // vrai si l'un des enfants de r a plus de alpha fois ses éléments
+    static bool unbalanced(const Node *r, const ScapegoatBalance &policy) noexcept {
+        size_t limit = size_t(policy.alpha * double(r->nbElements));
+        return subtreeSize(r->left) > limit or subtreeSize(r->right) > limit;
+    }
+
+    //
+    // @brief Reconstruit un sous arbre si l'un de ses enfants a plus de alpha fois ses éléments
+    //
+    // @param r la racine du sous arbre, peut valoir nullptr. Remplacée par la nouvelle racine
+    // @return vrai si le sous arbre a été reconstruit
+    // @remark Complexité : O(1), O(n) si le sous arbre est reconstruit
+    //
+    template<typename B>
+    static bool rebuildIfUnbalanced(Node *&, const B &) noexcept {
+        return false;
+    }
+
+    static bool rebuildIfUnbalanced(Node *&r, ScapegoatBalance &policy) noexcept {
+        if (r == nullptr or !unbalanced(r, policy))
+            return false;
+
+        Node *parent = r->parent;
+        size_t cnt = 0;
+        Node *list = nullptr;
+        countEvent(&CounterStore::rebuilds);
+        linearize(r, list, cnt);
+        arborize(r, list, cnt);
+        setParent(r, parent);
+
+        ++policy.stats.rebuilds;
+        policy.stats.rebuiltNodes += cnt;
+        policy.stats.largest = std::max(policy.stats.largest, cnt);
+        return true;
+    }
+
+    //
+    // @brief Reconstruit le plus haut sous arbre déséquilibré de chacun des deux
+    //        bords d'un arbre, seuls modifiés par split et join
+    //
+    template<typename B>
+    void rebuildSpines(Node *&, const B &) noexcept {}
+
+    void rebuildSpines(Node *&r, ScapegoatBalance &policy) noexcept {
+        for (Node **link = &r; *link != nullptr; link = &(*link)->left)
+            if (rebuildIfUnbalanced(*link, policy))
+                break;
+        for (Node **link = &r; *link != nullptr; link = &(*link)->right)
+            if (rebuildIfUnbalanced(*link, policy))
+                break;
+    }
+
+public:
+    //
+    // @brief Insertion d'un lot de cles
+    //
+    // @param first début de la séquence de cles
+    // @param last fin de la séquence de cles
+    //
+    // @return le nombre de cles effectivement insérées
+    //
+    // Le lot est trié puis fusionné avec l'arbre en un seul parcours : les cles
+    // qui partagent un début de chemin ne le parcourent qu'une fois, et chaque
+    // noeud touché n'est mis à jour (nbElements, équilibrage) qu'une seule fois.
+    // Les cles qui tombent dans un même sous arbre vide y sont arborisées
+    // directement. Tous les noeuds sont créés avant de modifier l'arbre : en cas
+    // d'exception, l'arbre n'est pas modifié.
+    //
+    // @remark Complexité : O(m log(m) + m log(n / m + 1)) pour m cles dans un arbre équilibré
+    //
+    template<typename InputIt>
+    size_t insertBatch(InputIt first, InputIt last) {
+        std::vector<Node *> nodes;
+        std::vector<const value_type *> keys;
+        Node *list = nullptr;
+        Node **tail = &list;
+        size_t cnt = 0;
+
+        try {
+            for (; first != last; ++first) {
+                *tail = createNode(*first);
+                tail = &(*tail)->right;
+                ++cnt;
+            }
+            sortList(list, cnt);
+            nodes.reserve(cnt);
+            keys.reserve(cnt);
+        } catch (...) {
+            deleteSubTree(list);
+            throw;
+        }
+
+        for (Node *n = list; n != nullptr; n = n->right) {
+            nodes.push_back(n);
+            keys.push_back(&n->key);
+        }
+
+        size_t before = size();
+        mergeBatch(keys, BatchOp::Insert, nodes.data(), nullptr);
+
+        // Les noeuds dont la cle était déjà présente n'ont pas été utilisés
+        for (Node *n : nodes)
+            if (n != nullptr)
+                destroyNode(n);
+        return size() - before;
+    }
+
+    //
+    // @brief Suppression d'un lot de cles
+    //
+    // @param first début de la séquence de cles
+    // @param last fin de la séquence de cles
+    //
+    // @return le nombre de cles effectivement supprimées
+    //
+    // même parcours fusionné que insertBatch. En multiensemble, chaque cle du lot
+    // retire une occurrence
+    //
+    // @remark Complexité : O(m log(m) + m log(n / m + 1)) pour m cles dans un arbre équilibré
+    //
+    template<typename InputIt>
+    size_t eraseBatch(InputIt first, InputIt last) {
+        std::vector<value_type> sorted(first, last);
+        std::sort(sorted.begin(), sorted.end(), _comp);
+        // En multiensemble, chaque cle du lot retire une occurrence
+        if (!IsMultiset)
+            sorted.erase(std::unique(sorted.begin(), sorted.end(), [this](const_reference a, const_reference b) {
+                return !less(a, b);
+            }), sorted.end());
+
+        std::vector<const value_type *> keys;
+        keys.reserve(sorted.size());
+        for (const_reference key : sorted)
+            keys.push_back(&key);
+
+        size_t before = size();
+        mergeBatch(keys, BatchOp::Erase, nullptr, nullptr);
+        return before - size();
+    }
+
+    //
+    // @brief Recherche d'un lot de cles
+    //
+    // @param first début de la séquence de cles
+    // @param last fin de la séquence de cles
+    //
+    // @return pour chaque cle, dans l'ordre de la séquence, vrai si elle est présente
+    //
+    // même parcours fusionné que insertBatch, l'arbre n'est pas modifié
+    // @remark Complexité : O(m log(m) + m log(n / m + 1)) pour m cles dans un arbre équilibré
+    //
+    template<typename InputIt>
+    std::vector<bool> containsBatch(InputIt first, InputIt last) const {
+        std::vector<value_type> batch(first, last);
+        std::vector<const value_type *> keys;
+        keys.reserve(batch.size());
+        for (const_reference key : batch)
+            keys.push_back(&key);
+        std::stable_sort(keys.begin(), keys.end(), [this](const value_type *a, const value_type *b) {
+            return less(*a, *b);
+        });
+
+        std::unique_ptr<bool[]> sortedFound(new bool[keys.size()]());
+        const_cast<BinarySearchTree *>(this)->mergeBatch(keys, BatchOp::Lookup, nullptr, sortedFound.get());
+
+        std::vector<bool> found(batch.size());
+        for (size_t i = 0; i < keys.size(); ++i)
+            found[keys[i] - batch.data()] = sortedFound[i];
+        return found;
+    }
+
+private:
+    enum class BatchOp { Insert, Erase, Lookup, Retain };
+
+    /**
+     * @brief Fusionne un lot trié de clés avec l'arbre en un seul parcours
+     *
+     * Chaque cadre associe un sous arbre à la tranche [b, e) du lot dont les clés y
+     * tombent. La tranche est coupée par la clé de la racine, les deux moitiés
+     * descendent à gauche et à droite, puis le noeud est recollé une seule fois à
+     * ses sous arbres par join, qui rétablit l'équilibre si nécessaire.
+     *
+     * @param keys les clés du lot, triées
+     * @param op l'opération à appliquer. Retain supprime les clés absentes du lot
+     * @param nodes (Insert) les noeuds à insérer, alignés sur keys. Ceux qui sont
+     *              utilisés sont remplacés par nullptr
+     * @param found (Lookup) reçoit vrai pour chaque clé présente, aligné sur keys
+     * @param copies (Erase, Retain) en multiensemble, le nombre d'occurrences de
+     *               chaque clé du lot, aligné sur keys. nullptr pour une chacune
+     * @exception std::bad_alloc si la pile ne peut être allouée, avant toute
+     *            modification de l'arbre : la pile est réservée d'avance (voir batchDepth)
+     * @remark Complexité : O(m log(n / m + 1)) pour m clés dans un arbre équilibré
+     */
+    void mergeBatch(const std::vector<const value_type *> &keys, BatchOp op, Node **nodes, bool *found,
+                    const size_t *copies = nullptr) {
+        struct Frame {
+            Node **slot;   // lien vers la racine du sous arbre
+            Node *parent;  // parent de cette racine
+            size_t b, e;   // tranche du lot qui tombe dans ce sous arbre
+            size_t m, m2;  // clés égales à celle de la racine : [m, m2)
+            int step;      // 0 : à découper, 1 : droite à traiter, 2 : à recoller
+        };
+        auto byKey = [this](const value_type *a, const value_type *b) { return less(*a, *b); };
+
+        NodeStack<Frame> stack;
+        // Une fois l'arbre modifié, un push ne doit plus pouvoir échouer. Un AVL
+        // est toujours assez bas pour que la pile tienne dans l'objet
+        if (op != BatchOp::Lookup and !std::is_same<Balance, AVLBalance>::value)
+            stack.reserve(batchDepth(keys));
+        if (!keys.empty())
+            stack.push(Frame{&_root, nullptr, 0, keys.size(), 0, 0, 0});
+
+        while (!stack.empty()) {
+            Frame &f = stack.top();
+            Node *r = *f.slot;
+
+            if (f.step == 0) {
+                // Sous arbre vide : les clés de la tranche y sont arborisées
+                if (r == nullptr) {
+                    if (op == BatchOp::Insert)
+                        attachNodes(*f.slot, f.parent, nodes + f.b, f.e - f.b);
+                    stack.pop();
+                    continue;
+                }
+                f.m = std::lower_bound(keys.begin() + f.b, keys.begin() + f.e, &r->key, byKey) - keys.begin();
+                f.m2 = std::upper_bound(keys.begin() + f.m, keys.begin() + f.e, &r->key, byKey) - keys.begin();
+                if (op == BatchOp::Lookup)
+                    for (size_t i = f.m; i < f.m2; ++i)
+                        found[i] = true;
+                f.step = 1;
+                if (f.b < f.m)
+                    stack.push(Frame{&r->left, r, f.b, f.m, 0, 0, 0});
+                else if (op == BatchOp::Retain)
+                    dropSubTree(r->left);
+            } else if (f.step == 1) {
+                f.step = 2;
+                if (f.m2 < f.e)
+                    stack.push(Frame{&r->right, r, f.m2, f.e, 0, 0, 0});
+                else if (op == BatchOp::Retain)
+                    dropSubTree(r->right);
+            } else {
+                if (op != BatchOp::Lookup) {
+                    Node *root;
+                    bool remove = op == BatchOp::Erase ? f.m < f.m2 : op == BatchOp::Retain and f.m == f.m2;
+                    // En multiensemble, les occurrences du lot s'ajoutent à celles du noeud
+                    // (Insert), s'en retranchent (Erase) ou les bornent (Retain)
+                    if (IsMultiset and f.m < f.m2) {
+                        size_t batch = 0, have = multiplicity(r);
+                        for (size_t i = f.m; i < f.m2; ++i)
+                            batch += op == BatchOp::Insert ? multiplicity(nodes[i]) : copies != nullptr ? copies[i] : 1;
+                        if (op == BatchOp::Insert) {
+                            setMultiplicity(r, have + batch);
+                        } else if (op == BatchOp::Retain) {
+                            setMultiplicity(r, std::min(have, batch));
+                        } else if (batch < have) {
+                            setMultiplicity(r, have - batch);
+                            remove = false;
+                        }
+                    }
+                    if (remove) {
+                        root = join2(r->left, r->right);
+                        destroyNode(r);
+                    } else {
+                        root = join(r->left, r, r->right);
+                    }
+                    *f.slot = root;
+                    setParent(root, f.parent);
+                    rebuildIfUnbalanced(*f.slot, _balance);
+                }
+                stack.pop();
+            }
+        }
+    }
+
+    /**
+     * @brief Nombre maximal de cadres empilés par mergeBatch pour ce lot
+     *
+     * Un cadre est empilé pour chaque noeud (ou lien vide) des chemins de
+     * recherche des clés du lot. mergeBatch ne modifie un sous arbre qu'une fois
+     * tous ses cadres dépilés, les chemins restant à parcourir sont donc les mêmes
+     * que dans l'arbre de départ. L'arbre n'est pas modifié.
+     *
+     * @param keys les clés du lot, triées
+     * @remark Complexité : O(m log(n / m + 1)) pour m clés dans un arbre équilibré
+     */
+    size_t batchDepth(const std::vector<const value_type *> &keys) const {
+        struct Frame {
+            const Node *node;
+            size_t b, e;   // tranche du lot qui tombe dans ce sous arbre
+            size_t depth;  // cadres empilés jusqu'à celui-ci
+        };
+        auto byKey = [this](const value_type *a, const value_type *b) { return less(*a, *b); };
+
+        NodeStack<Frame> stack;
+        size_t depth = 0;
+        if (!keys.empty())
+            stack.push(Frame{_root, 0, keys.size(), 1});
+        while (!stack.empty()) {
+            Frame f = stack.pop();
+            depth = std::max(depth, f.depth);
+            if (f.node == nullptr)
+                continue;
+            size_t m = std::lower_bound(keys.begin() + f.b, keys.begin() + f.e, &f.node->key, byKey) - keys.begin();
+            size_t m2 = std::upper_bound(keys.begin() + m, keys.begin() + f.e, &f.node->key, byKey) - keys.begin();
+            if (f.b < m)
+                stack.push(Frame{f.node->left, f.b, m, f.depth + 1});
+            if (m2 < f.e)
+                stack.push(Frame{f.node->right, m2, f.e, f.depth + 1});
+        }
+        return depth;
+    }
+
+    /**
+     * @brief Arborise des noeuds triés dans un sous arbre vide
+     * @param slot le lien (nullptr) où placer le sous arbre
+     * @param parent le parent du sous arbre
+     * @param nodes les noeuds, triés. Ils sont remplacés par nullptr
+     * @param cnt le nombre de noeuds
+     * @remark Complexité : O(cnt)
+     */
+    static void attachNodes(Node *&slot, Node *parent, Node **nodes, size_t cnt) noexcept {
+        Node *list = nullptr;
+        for (size_t i = cnt; i-- > 0;) {
+            nodes[i]->right = list;
+            list = nodes[i];
+            nodes[i] = nullptr;
+        }
+        arborize(slot, list, cnt);
+        setParent(slot, parent);
+    }
+
+    /**
+     * @brief Recolle deux sous arbres autour d'un noeud
+     *
+     * Toutes les clés de left doivent être plus petites que celle de mid, elle-même
+     * plus petite que toutes celles de right. La politique d'équilibrage rétablit
+     * son invariant quelles que soient les tailles des deux sous arbres.
+     *
+     * @param left le sous arbre gauche, peut valoir nullptr
+     * @param mid le noeud central, ses liens sont écrasés
+     * @param right le sous arbre droit, peut valoir nullptr
+     * @return la racine du sous arbre obtenu, dont le parent est à fixer par l'appelant
+     * @remark Complexité : O(1) sans équilibrage, O(|h(left) - h(right)| + 1) pour AVL
+     */
+    static Node *join(Node *left, Node *mid, Node *right) noexcept {
+        return join(left, mid, right, Balance());
+    }
+
+    static Node *join(Node *left, Node *mid, Node *right, NoBalance) noexcept {
+        mid->left = left;
+        mid->right = right;
+        setParent(left, mid);
+        setParent(right, mid);
+        update(mid);
+        return mid;
+    }
+
+    static Node *join(Node *left, Node *mid, Node *right, AVLBalance) noexcept {
+        unsigned hl = avlHeight(left), hr = avlHeight(right);
+        if (hl <= hr + 1 and hr <= hl + 1)
+            return join(left, mid, right, NoBalance());
+
+        // On descend le long du bord du plus haut des deux arbres jusqu'à un sous arbre
+        // de hauteur comparable à l'autre, on y accroche mid, puis on remonte en
+        // rééquilibrant comme après une insertion
+        bool leftTaller = hl > hr;
+        Node *root = leftTaller ? left : right;
+        unsigned target = (leftTaller ? hr : hl) + 1;
+        Node **link = &root;
+        Node *parent = nullptr;
+        while (avlHeight(*link) > target) {
+            parent = *link;
+            link = leftTaller ? &(*link)->right : &(*link)->left;
+        }
+        *link = leftTaller ? join(*link, mid, right, NoBalance()) : join(left, mid, *link, NoBalance());
+        mid->parent = parent;
+
+        retrace(parent, root);
+        root->parent = nullptr;
+        return root;
+    }
+
+    static Node *join(Node *left, Node *mid, Node *right, ScapegoatBalance) noexcept {
+        size_t sl = subtreeSize(left), sr = subtreeSize(right);
+        if (sl <= 2 * sr + 1 and sr <= 2 * sl + 1)
+            return join(left, mid, right, NoBalance());
+
+        // Comme pour AVL, mais on s'arrête au premier sous arbre du bord au plus deux
+        // fois plus lourd que l'autre arbre. Les ancêtres trop chargés sont ensuite
+        // reconstruits par l'appelant
+        bool leftHeavier = sl > sr;
+        size_t other = leftHeavier ? sr : sl;
+        Node *root = leftHeavier ? left : right;
+        Node **link = &root;
+        Node *parent = nullptr;
+        while (subtreeSize(*link) > 2 * other + 1) {
+            parent = *link;
+            link = leftHeavier ? &(*link)->right : &(*link)->left;
+        }
+        *link = leftHeavier ? join(*link, mid, right, NoBalance()) : join(left, mid, *link, NoBalance());
+        mid->parent = parent;
+
+        retrace(parent, root);
+        root->parent = nullptr;
+        return root;
+    }
+
+    /**
+     * @brief Recolle deux sous arbres sans noeud central
+     *
+     * La plus petite clé de right sert de noeud central.
+     *
+     * @param left le sous arbre gauche, peut valoir nullptr
+     * @param right le sous arbre droit, ses clés plus grandes que celles de left
+     * @return la racine du sous arbre obtenu, dont le parent est à fixer par l'appelant
+     * @remark Complexité moyenne : O(log(n))
+     */
+    static Node *join2(Node *left, Node *right) noexcept {
+        if (left == nullptr)
+            return right;
+        if (right == nullptr)
+            return left;
+        Node *mid = detachMin(right);
+        return join(left, mid, right);
+    }
+
+public:
+    //
+    // @brief Coupe l'arbre en deux autour d'une cle
+    //
+    // Les noeuds sont recousus, pas copiés : le long du chemin vers key, chaque
+    // noeud est recollé par join au morceau de son côté. L'arbre courant est vidé.
+    //
+    // @param key la cle de coupure, présente ou non
+    // @return (cles < key, cles >= key), avec le même allocateur que l'arbre courant
+    // @remark Complexité : O(log(n)) pour un arbre équilibré
+    //
+    std::pair<BinarySearchTree, BinarySearchTree> split(const_reference key) {
+        std::pair<BinarySearchTree, BinarySearchTree> parts{BinarySearchTree(_comp), BinarySearchTree(_comp)};
+        parts.first._alloc = parts.second._alloc = _alloc;
+        parts.first._balance = parts.second._balance = _balance;
+
+        NodeStack<Node *> path;
+        for (Node *n = _root; n != nullptr; n = less(n->key, key) ? n->right : n->left)
+            path.push(n);
+        _root = nullptr;
+
+        // En remontant, les noeuds plus petits que key prennent leur sous arbre gauche
+        // et le morceau déjà construit sous eux (à leur droite), les autres l'inverse
+        Node *lt = nullptr, *ge = nullptr;
+        while (!path.empty()) {
+            Node *n = path.pop();
+            if (less(n->key, key))
+                lt = join(n->left, n, lt);
+            else
+                ge = join(ge, n, n->right);
+        }
+        setParent(lt, nullptr);
+        setParent(ge, nullptr);
+
+        parts.first._root = lt;
+        parts.second._root = ge;
+        parts.first.rebuildSpines(parts.first._root, parts.first._balance);
+        parts.second.rebuildSpines(parts.second._root, parts.second._balance);
+        return parts;
+    }
+
+    //
+    // @brief Ajoute à la fin de l'arbre toutes les cles de right, qui est vidé
+    //
+    // @param right un arbre dont toutes les cles sont plus grandes que celles de
+    //              l'arbre courant, et dont l'allocateur est égal
+    // @exception std::logic_error si les cles ne sont pas ordonnées ou si les
+    //            allocateurs diffèrent. Aucun des deux arbres n'est alors modifié
+    // @remark Complexité : O(log(n)) pour des arbres équilibrés
+    //
+    void join(BinarySearchTree &right) {
+        if (right._root == nullptr)
+            return;
+        if (_alloc != right._alloc)
+            throw std::logic_error("Les deux arbres n'ont pas le meme allocateur");
+        if (_root != nullptr and !less(rightmost(_root)->key, leftmost(right._root)->key))
+            throw std::logic_error("Les cles de right doivent etre plus grandes");
+
+        _root = join2(_root, right._root);
+        right._root = nullptr;
+        setParent(_root, nullptr);
+        rebuildSpines(_root, _balance);
+    }
+
+    //
+    // @brief Union : ajoute les cles de other, qui est vidé
+    //
+    // Les noeuds du plus petit des deux arbres sont fusionnés dans le plus grand
+    // comme par insertBatch, sans être recréés. Ceux dont la cle était déjà
+    // présente sont détruits ; en multiensemble, leurs occurrences s'ajoutent.
+    //
+    // @param other l'arbre à fusionner, dont l'allocateur doit être égal
+    // @exception std::logic_error si les allocateurs diffèrent, std::bad_alloc.
+    //            Aucun des deux arbres n'est alors modifié
+    // @remark Complexité : O(m log(n / m + 1)), m étant la taille du plus petit arbre
+    //
+    void unionWith(BinarySearchTree &other) {
+        if (&other == this or other._root == nullptr)
+            return;
+        if (_alloc != other._alloc)
+            throw std::logic_error("Les deux arbres n'ont pas le meme allocateur");
+
+        // En multiensemble, le plus petit arbre est celui qui a le moins d'éléments
+        Node *smaller = other.size() > size() ? _root : other._root;
+        std::vector<Node *> nodes(nodeCount(smaller));
+        std::vector<const value_type *> keys(nodes.size());
+        if (smaller == _root)
+            std::swap(_root, other._root);
+        flatten(other._root, nodes.data(), 1);
+        other._root = nullptr;
+        for (size_t i = 0; i < nodes.size(); ++i)
+            keys[i] = &nodes[i]->key;
+
+        mergeBatch(keys, BatchOp::Insert, nodes.data(), nullptr);
+        for (Node *n : nodes)
+            if (n != nullptr)
+                destroyNode(n);
+    }
+
+    //
+    // @brief Intersection : ne garde que les cles présentes dans other
+    //
+    // Le plus petit des deux arbres est parcouru et chacune de ses cles est
+    // cherchée dans l'autre. Si other est le plus petit, ses cles forment un lot
+    // comme pour eraseBatch, et les sous arbres où n'en tombe aucune sont détruits
+    // en bloc. Sinon, les noeuds de l'arbre courant dont la cle est absente de
+    // other sont détruits et les autres réarborisés. En multiensemble, chaque cle
+    // garde le plus petit de ses deux nombres d'occurrences.
+    //
+    // @param other l'arbre à comparer, qui n'est pas modifié
+    // @exception std::bad_alloc, l'arbre n'est alors pas modifié
+    // @remark Complexité : O(m log(n / m + 1)) si other est le plus petit, avec m
+    //         cles dans other, plus la destruction des noeuds supprimés ;
+    //         O(n log(m)) sinon. La mémoire utilisée en plus est en O(min(n, m))
+    //
+    void intersectWith(const BinarySearchTree &other) {
+        if (&other == this)
+            return;
+        if (other.size() < size()) {
+            std::vector<size_t> copies;
+            std::vector<const value_type *> keys = keysOf(other, copies);
+            if (keys.empty())
+                dropSubTree(_root);
+            else
+                mergeBatch(keys, BatchOp::Retain, nullptr, nullptr, copies.empty() ? nullptr : copies.data());
+            return;
+        }
+
+        std::vector<Node *> nodes(nodeCount(_root));
+        flatten(_root, nodes.data(), 1);
+        _root = nullptr;
+        size_t kept = 0;
+        for (Node *n : nodes) {
+            size_t there = other.count(n->key);
+            if (there == 0) {
+                destroyNode(n);
+            } else {
+                setMultiplicity(n, std::min(multiplicity(n), there));
+                nodes[kept++] = n;
+            }
+        }
+        attachNodes(_root, nullptr, nodes.data(), kept);
+    }
+
+    //
+    // @brief Différence : supprime les cles présentes dans other
+    //
+    // En multiensemble, les occurrences de other sont retranchées de celles de l'arbre.
+    //
+    // @param other l'arbre à comparer, qui n'est pas modifié
+    // @remark Complexité : O(m log(n / m + 1)) pour m cles dans other
+    //
+    void differenceWith(const BinarySearchTree &other) {
+        if (&other == this) {
+            dropSubTree(_root);
+            return;
+        }
+        std::vector<size_t> copies;
+        std::vector<const value_type *> keys = keysOf(other, copies);
+        mergeBatch(keys, BatchOp::Erase, nullptr, nullptr, copies.empty() ? nullptr : copies.data());
+    }
+
+private:
+    // adresses des cles d'un arbre, par ordre croissant, et en multiensemble leurs multiplicités
+    static std::vector<const value_type *> keysOf(const BinarySearchTree &tree, std::vector<size_t> &copies) {
+        std::vector<const value_type *> keys;
+        keys.reserve(nodeCount(tree._root));
+        forEachNode(tree._root, [&](Node *n) {
+            keys.push_back(&n->key);
+            if (IsMultiset)
+                copies.push_back(multiplicity(n));
+        });
+        return keys;
+    }
+
+    // détruit un sous arbre et vide le lien qui y menait
+    void dropSubTree(Node *&r) noexcept {
+        deleteSubTree(r);
+        r = nullptr;
+    }
+
+public:
+    //
+    // @brief taille de l'arbre
+    //
+    // @return le nombre d'elements de l'arbre
+    // @remark Complexité : O(1)
+    //
+    size_t size() const noexcept {
+        return subtreeSize(_root);
+    }
+
+    //
+    // @brief hauteur de l'arbre
+    //
+    // @return le nombre de noeuds du plus long chemin depuis la racine, 0 si l'arbre est vide
+    // @remark Complexité : O(n)
+    //
+    size_t height() const {
+        struct Frame {
+            Node *node;
+            size_t depth;
+        };
+        NodeStack<Frame> stack;
+        size_t h = 0;
+        if (_root != nullptr)
+            stack.push(Frame{_root, 1});
+        while (!stack.empty()) {
+            Frame f = stack.pop();
+            h = std::max(h, f.depth);
+            if (f.node->left != nullptr)
+                stack.push(Frame{f.node->left, f.depth + 1});
+            if (f.node->right != nullptr)
+                stack.push(Frame{f.node->right, f.depth + 1});
+        }
+        return h;
+    }
+
+    /**
+     *  @brief Forme de l'arbre, voir stats()
+     */
+    struct TreeStats {
+        size_t nodes = 0;                   // nombre de noeuds
+        size_t height = 0;                  // noeuds du plus long chemin depuis la racine, 0 si vide
+        size_t maxDepth = 0;                // profondeur du noeud le plus profond, la racine est à 0
+        double averageDepth = 0;            // profondeur moyenne des noeuds
+        std::vector<size_t> depthHistogram; // nombre de noeuds à chaque profondeur
+        size_t bytes = 0;                   // mémoire des noeuds et de l'arbre, hors surcoût de l'allocateur
+        double balanceFactor = 1;           // height divisée par la hauteur minimale pour ce nombre de noeuds, 1 au mieux
+    };
+
+    //
+    // @brief Mesure la forme de l'arbre
+    //
+    // Un seul parcours, sans allocation hormis l'histogramme (une case par niveau).
+    // Un balanceFactor élevé indique qu'un appel à balance() réduirait nettement
+    // le coût des recherches.
+    // @remark Complexité : O(n) en temps, O(h) en mémoire
+    //
+    TreeStats stats() const {
+        struct Frame {
+            Node *node;
+            size_t depth;
+        };
+        TreeStats st;
+        NodeStack<Frame> stack;
+        size_t depthSum = 0;
+        if (_root != nullptr)
+            stack.push(Frame{_root, 0});
+        while (!stack.empty()) {
+            Frame f = stack.pop();
+            if (f.depth >= st.depthHistogram.size())
+                st.depthHistogram.resize(f.depth + 1, 0);
+            ++st.depthHistogram[f.depth];
+            ++st.nodes;
+            depthSum += f.depth;
+            if (f.node->left != nullptr)
+                stack.push(Frame{f.node->left, f.depth + 1});
+            if (f.node->right != nullptr)
+                stack.push(Frame{f.node->right, f.depth + 1});
+        }
+
+        st.height = st.depthHistogram.size();
+        st.maxDepth = st.height != 0 ? st.height - 1 : 0;
+        st.bytes = sizeof(*this) + st.nodes * sizeof(Node);
+        if (st.nodes != 0) {
+            size_t minHeight = 0;
+            while (minHeight < 64 and (size_t(1) << minHeight) - 1 < st.nodes)
+                ++minHeight;
+            st.averageDepth = double(depthSum) / double(st.nodes);
+            st.balanceFactor = double(st.height) / double(std::max<size_t>(minHeight, 1));
+        }
+        return st;
+    }
+
+    /**
+     *  @brief Valeurs des compteurs d'évènements, voir counters()
+     */
+    struct Counters {
+        size_t comparisons = 0;   // appels au comparateur, une comparaison à trois issues compte pour un
+        size_t allocations = 0;   // noeuds alloués
+        size_t deallocations = 0; // noeuds libérés
+        size_t rotations = 0;     // rotations AVL
+        size_t rebuilds = 0;      // sous arbres reconstruits (balance, balanceParallel, ScapegoatBalance)
+    };
+
+#ifdef BST_COUNTERS
+    static const bool CountersEnabled = true;
+#else
+    static const bool CountersEnabled = false;
+#endif
+
+    //
+    // @brief Compteurs d'évènements de tous les arbres de ce type
+    //
+    // Ils ne sont tenus que si BST_COUNTERS est défini à la compilation, sinon
+    // ils valent toujours 0 et ne coûtent rien. Pour mesurer une opération, on
+    // fait la différence avant et après.
+    // @remark Complexité : O(1)
+    //
+    static Counters counters() noexcept {
+        Counters c;
+#ifdef BST_COUNTERS
+        CounterStore &store = counterStore();
+        c.comparisons = store.comparisons.load(std::memory_order_relaxed);
+        c.allocations = store.allocations.load(std::memory_order_relaxed);
+        c.deallocations = store.deallocations.load(std::memory_order_relaxed);
+        c.rotations = store.rotations.load(std::memory_order_relaxed);
+        c.rebuilds = store.rebuilds.load(std::memory_order_relaxed);
+#endif
+        return c;
+    }
+
+    static void resetCounters() noexcept {
+#ifdef BST_COUNTERS
+        CounterStore &store = counterStore();
+        store.comparisons.store(0, std::memory_order_relaxed);
+        store.allocations.store(0, std::memory_order_relaxed);
+        store.deallocations.store(0, std::memory_order_relaxed);
+        store.rotations.store(0, std::memory_order_relaxed);
+        store.rebuilds.store(0, std::memory_order_relaxed);
+#endif
+    }
+
+    //
+    // @brief cle en position n
+    //
+    // @return une reference a la cle en position n par ordre croissant des
+    // elements. En multiensemble, une clé présente k fois occupe k positions
+    //
+    // @exception std::logic_error si nécessaire
+    //
+    // ajoutez le code de gestion des exceptions, puis mettez en oeuvre
+    // la fonction nth_element(Node*, n)
+    // @remark Complexité : O(log(n))
+    //
+    const_reference nth_element(size_t n) const {
+
+        // gestion des exceptions
+        if (_root == nullptr)
+            throw std::logic_error("Il n'y a aucun éléments dans l'arbre!");
+        if (n >= size())
+            throw std::logic_error("Index trop grand");
+
+        return nth_element(_root, n);
+    }
+
+private:
+
+    // @brief cle en position n dans un sous arbre
+    //
+    // @param r la racine du sous arbre. ne peut pas etre nullptr
+    // @param n la position n
+    //
+    // @return une reference a la cle en position n par ordre croissant des
+    // elements
+    //
+    static const_reference nth_element(Node *r, size_t n) noexcept {
+        while (true) {
+            size_t leftCount = subtreeSize(r->left);
+
+            // check pour savoir si l'on doit chercher la valeur a gauche ou a droite de l'arbre
+            // si la position est plus petite que le nbre d'éléments a gauche, il faut aller a gauche
+            if (n < leftCount) {
+                r = r->left;
+            }
+            // si la position tombe sur une des occurrences de la clé du noeud, on a trouvé notre Node
+            else if (n < leftCount + multiplicity(r)) {
+                return r->key;
+            }
+            // si la position est plus grande que le nbre d'éléments a gauche, il faut aller a droite
+            //  et l'on soustrait le nbre d'élément a gauche et du noeud à la position
+            else {
+                n -= leftCount + multiplicity(r);
+                r = r->right;
+            }
+        }
+    }
+
+public:
+    //
+    // @brief position d'une cle dans l'ordre croissant des elements de l'arbre
+    //
+    // @param key la cle dont on cherche le rang
+    //
+    // @return la position entre 0 et size()-1, size_t(-1) si la cle est absente.
+    //         En multiensemble, la position de sa première occurrence
+    //
+    // Ne pas modifier mais écrire la fonction
+    // privée rank(Node*,const_reference)
+    // @remark Complexité moyenne : O(log(n))
+    //
+    size_t rank(const_reference key) const noexcept {
+        return rank(_root, key);
+    }
+
+    // recherche hétérogène, voir contains
+    template<typename K, typename = EnableIfLookup<K>>
+    size_t rank(const K &key) const noexcept {
+        return rank(_root, key);
+    }
+
+    //
+    // @brief position d'une cle, ou position à laquelle elle serait insérée
+    //
+    // @param key la cle dont on cherche le rang
+    //
+    // @return une paire (position, présente). Si la cle est présente, la position
+    //         est son rang, sinon c'est le nombre de cles plus petites qu'elle,
+    //         donc son rang une fois insérée
+    //
+    // une seule descente, la cle n'est comparée qu'aux noeuds du chemin
+    // @remark Complexité : O(h), h la hauteur de l'arbre
+    //
+    std::pair<size_t, bool> rankOrInsertionPoint(const_reference key) const noexcept {
+        return rankOrInsertionPoint(_root, key);
+    }
+
+private:
+    //
+    // @brief position d'une cle dans l'ordre croissant des elements du sous-arbre
+    //
+    // @param key la cle dont on cherche le rang
+    // @param r la racine du sous arbre
+    //
+    // @return la position entre 0 et size()-1, size_t(-1) si la cle est absente
+    // @remark Complexité : O(h), h la hauteur de l'arbre
+    //
+    template<typename K>
+    size_t rank(Node *r, const K &key) const noexcept {
+        std::pair<size_t, bool> position = rankOrInsertionPoint(r, key);
+        return position.second ? position.first : size_t(-1);
+    }
+
+    //
+    // @brief position d'une cle dans un sous arbre, ou position à laquelle elle serait insérée
+    //
+    // @param r la racine du sous arbre
+    // @param key la cle dont on cherche le rang
+    //
+    // @return une paire (position, présente)
+    // @remark Complexité : O(h), h la hauteur du sous arbre
+    //
+    template<typename K>
+    std::pair<size_t, bool> rankOrInsertionPoint(Node *r, const K &key) const noexcept {
+        // nombre de clés plus petites que key rencontrées en descendant
+        size_t smaller = 0;
+
+        while (r != nullptr) {
+            int c = compare(key, r->key);
+            if (c < 0) {
+                r = r->left;
+            } else if (c > 0) {
+                smaller += subtreeSize(r->left) + multiplicity(r);
+                r = r->right;
+            } else {
+                return std::make_pair(smaller + subtreeSize(r->left), true);
+            }
+        }
+        return std::make_pair(smaller, false);
+    }
+
+public:
+    //
+    // @brief linearise l'arbre
+    //
+    // transforme l'arbre en une liste simplement chainee composee des memes
+    // noeuds que precedemment, mais dont les pointeurs left sont tous egaux
+    // a nullptr. Cette liste doit toujours respecter les conditions d'un
+    // arbre binaire de recherche
+    //
+    // Ne pas modifier cette fonction qui sert essentiellement a tester la
+    // fonction linearize(Node*, Node*&, size_t&) utilisée par
+    // la methode publique arborize
+    //
+    // @remark Complexité : O(n)
+    //
+    void linearize() noexcept {
+        size_t cnt = 0;
+        Node *list = nullptr;
+        linearize(_root, list, cnt);
+        _root = list;
+    }
+
+private:
+    //
+    // @brief linearise une sous arbre tree en une liste
+    //
+    // @param tree pointe vers la racine de l'arbre a lineariser
+    // @param list reference a la tete de la liste a creer. sera modifiee
+    //             par la fonction pour que list pointe vers le plus petit
+    //             element de tree
+    // @param cnt  calcule au fure et a mesure le nombre d'elements de la liste
+    //             cree. l'effet de la fonction doit etre d'ajouter le nombre
+    //             d'elements du sous-arbre de racine tree. Cependant, vous
+    //             avez uniquement le droit d'utiliser l'opérateur ++.
+    // @remark Complexité : O(n)
+    //
+    static void linearize(Node *tree, Node *&list, size_t &cnt) noexcept {
+        // Rotations à gauche jusqu'à ce qu'aucun noeud n'ait d'enfant droit : le sous arbre
+        // devient une liste chainée par la gauche, de la plus grande à la plus petite clé
+        Node **link = &tree;
+        while (*link != nullptr) {
+            Node *r = *link;
+            if (r->right != nullptr) {
+                Node *x = r->right;
+                r->right = x->left;
+                x->left = r;
+                *link = x;
+            } else {
+                link = &r->left;
+            }
+        }
+
+        // On parcourt cette liste en ajoutant chaque noeud en tête de list
+        while (tree != nullptr) {
+            Node *next = tree->left;
+            // Stock dans l'enfant droit, le noeud de la list et la list contient le noeud courant
+            tree->right = list;
+            setParent(list, tree);
+            tree->left = nullptr;
+            tree->parent = nullptr;
+            list = tree;
+            // Mise à jour du count et du nb des éléments du noeud courant
+            ++cnt;
+            update(tree);
+            tree = next;
+        }
+    }
+
+public:
+    //
+    // @brief equilibre l'arbre
+    //
+    // applique l'algorithme d'equilibrage de l'arbre par linearisation et
+    // arborisation
+    //
+    // Ne pas modifier cette fonction.
+    //
+    void balance() noexcept {
+        countEvent(&CounterStore::rebuilds);
+        size_t cnt = 0;
+        Node *list = nullptr;
+        linearize(_root, list, cnt);
+        arborize(_root, list, cnt);
+    }
+
+    //
+    // @brief facteur d'équilibre des poids de ScapegoatBalance
+    //
+    // @return la proportion maximale des éléments d'un sous arbre que peut
+    //         contenir l'un de ses enfants
+    //
+    double alpha() const noexcept {
+        return _balance.alpha;
+    }
+
+    //
+    // @brief modifie le facteur d'équilibre des poids de ScapegoatBalance
+    //
+    // Les sous arbres qui ne respectent pas la nouvelle valeur sont reconstruits
+    // au fil des modifications suivantes, pas immédiatement.
+    //
+    // @param alpha le nouveau facteur
+    // @exception std::logic_error si alpha n'est pas dans [0.5, 1)
+    //
+    void setAlpha(double alpha) {
+        if (!(alpha >= 0.5 and alpha < 1))
+            throw std::logic_error("alpha doit etre dans [0.5, 1)");
+        _balance.alpha = alpha;
     }
 
-private:
     //
-    // @brief linearise une sous arbre tree en une liste
+    // @brief statistiques des reconstructions de ScapegoatBalance depuis la
+    //        création de l'arbre ou le dernier resetRebuildStats()
     //
-    // @param tree pointe vers la racine de l'arbre a lineariser
-    // @param list reference a la tete de la liste a creer. sera modifiee
-    //             par la fonction pour que list pointe vers le plus petit
-    //             element de tree
-    // @param cnt  calcule au fure et a mesure le nombre d'elements de la liste
-    //             cree. l'effet de la fonction doit etre d'ajouter le nombre
-    //             d'elements du sous-arbre de racine tree. Cependant, vous
-    //             avez uniquement le droit d'utiliser l'opérateur ++.
+    const ScapegoatBalance::Stats &rebuildStats() const noexcept {
+        return _balance.stats;
+    }
+
+    void resetRebuildStats() noexcept {
+        _balance.stats = ScapegoatBalance::Stats();
+    }
+
+    //
+    // @brief forme figée de l'arbre
+    //
+    // @return une copie immuable des cles, rangée dans des tableaux contigus
+    //         (ordre d'Eytzinger), qui répond à contains, rank, nth_element et
+    //         aux parcours d'intervalles sans suivre de pointeur. Elle compare
+    //         les cles avec le même comparateur. Un multiensemble y garde
+    //         chaque occurrence.
+    //         L'arbre lui-même n'est pas modifié.
     // @remark Complexité : O(n)
     //
-    static void linearize(Node *tree, Node *&list, size_t &cnt) noexcept {
-        if (tree == nullptr) {
+    FrozenBinarySearchTree<T, Compare> freeze() const {
+        return FrozenBinarySearchTree<T, Compare>(begin(), end(), _comp);
+    }
+
+    //
+    // @brief Ecrit une image de l'arbre dans un fichier
+    //
+    // @param path chemin du fichier, remplacé s'il existe
+    //
+    // L'image contient la forme figée (voir freeze), sans aucun pointeur. Elle
+    // est rouverte par openSnapshot sans être relue ni reconstruite.
+    // Réservé aux cles trivialement copiables.
+    // @exception std::runtime_error si le fichier ne peut être écrit
+    // @remark Complexité : O(n), la forme figée est construite en mémoire le temps de l'écriture
+    //
+    void saveSnapshot(const std::string &path) const {
+        SnapshotBinarySearchTree<T, Compare>::save(path, freeze());
+    }
+
+    //
+    // @brief Ouvre une image écrite par saveSnapshot, en lecture seule
+    //
+    // @param path chemin du fichier
+    // @return la forme figée projetée en mémoire : contains, rank, nth_element
+    //         et les parcours d'intervalles lisent directement le fichier
+    // @exception std::runtime_error si le fichier n'est pas une image compatible
+    // @remark Complexité : O(1), les pages sont chargées à la demande
+    //
+    static SnapshotBinarySearchTree<T, Compare> openSnapshot(const std::string &path,
+                                                             const Compare &comp = Compare()) {
+        return SnapshotBinarySearchTree<T, Compare>(path, comp);
+    }
+
+    //
+    // @brief Ecrit les cles dans un flux binaire, par ordre croissant
+    //
+    // @param out le flux, ouvert en mode binaire
+    //
+    // Les cles sont encodées par KeyCodec<T> et regroupées en blocs protégés par
+    // un crc32. Seul le bloc en cours est gardé en mémoire. En multiensemble,
+    // chaque cle est écrite autant de fois qu'elle est présente.
+    // @exception std::runtime_error si le flux est en erreur
+    // @remark Complexité : O(n)
+    //
+    void save(std::ostream &out) const {
+        StreamChunkWriter<T> writer(out, size());
+        forEachNode(_root, [&](Node *n) {
+            for (size_t i = multiplicity(n); i > 0; --i)
+                writer.push(n->key);
+        });
+        writer.finish();
+    }
+
+    //
+    // @brief Remplace les cles de l'arbre par celles d'un flux écrit par save
+    //
+    // @param in le flux, ouvert en mode binaire
+    //
+    // Les noeuds sont créés bloc par bloc et chaînés au fur et à mesure, puis
+    // arborisés comme dans balance : aucun tableau de toutes les cles n'est
+    // construit, la mémoire utilisée en plus de l'arbre se limite à un bloc.
+    // L'arbre obtenu est parfaitement équilibré.
+    // @exception std::runtime_error si le flux est tronqué, corrompu (somme de
+    //            contrôle, cles non strictement croissantes, ou décroissantes en
+    //            multiensemble) ou incompatible. L'arbre n'est alors pas modifié
+    // @remark Complexité : O(n)
+    //
+    void load(std::istream &in) {
+        StreamChunkReader<T> reader(in);
+        Node *list = nullptr;
+        Node **tail = &list;
+        Node *last = nullptr;
+        size_t cnt = 0;
+
+        try {
+            value_type key;
+            while (reader.next(key)) {
+                if (last != nullptr and !less(last->key, key)) {
+                    if (!IsMultiset or less(key, last->key))
+                        throw std::runtime_error("Cles non triees dans le flux");
+                    setMultiplicity(last, multiplicity(last) + 1);
+                    continue;
+                }
+                last = createNode(std::move(key));
+                *tail = last;
+                tail = &last->right;
+                ++cnt;
+            }
+        } catch (...) {
+            while (list != nullptr) {
+                Node *next = list->right;
+                destroyNode(list);
+                list = next;
+            }
+            throw;
+        }
+
+        deleteSubTree(_root);
+        arborize(_root, list, cnt);
+    }
+
+    //
+    // @brief equilibre l'arbre en utilisant plusieurs threads
+    //
+    // Meme resultat que balance(). Les noeuds sont d'abord ranges par ordre
+    // croissant dans un tableau, chaque thread remplissant la tranche d'un sous
+    // arbre (sa position est connue grace a nbElements). Puis les deux moities
+    // de chaque decoupe sont arborisees en parallele, jusqu'a epuisement des
+    // threads ou sous ParallelCutoff noeuds.
+    //
+    // @param threads nombre maximal de threads a utiliser, 1 pour tout faire
+    //                dans le thread appelant
+    // @exception std::bad_alloc si le tableau ne peut pas etre alloue, l'arbre
+    //            n'est alors pas modifie
+    // @remark Complexité : O(n), O(n / threads + log(n)) en temps ecoule
+    //
+    void balanceParallel(unsigned threads = defaultThreads()) {
+        size_t cnt = nodeCount(_root);
+        std::vector<Node *> nodes(cnt);
+        countEvent(&CounterStore::rebuilds);
+        flatten(_root, nodes.data(), threads);
+        arborize(_root, nodes.data(), cnt, threads);
+    }
+
+    /**
+     *  @brief Remplace le contenu de l'arbre par les clés d'une séquence, en
+     *         utilisant plusieurs threads pour le tri et l'arborisation
+     *
+     *  Même résultat que bulkLoad. Les noeuds sont créés dans le thread appelant,
+     *  l'allocateur n'ayant pas à être thread-safe. S'ils ne sont pas déjà triés,
+     *  chaque thread trie une tranche du tableau de noeuds, puis les tranches sont
+     *  fusionnées deux à deux, elles aussi en parallèle.
+     *
+     *  @param first début de la séquence
+     *  @param last fin de la séquence
+     *  @param threads nombre maximal de threads à utiliser
+     *  @exception si une exception survient, l'arbre n'est pas modifié
+     *  @remark Complexité : O(n) si la séquence est triée, O(n log(n)) sinon
+     */
+    template<typename InputIt>
+    void bulkLoadParallel(InputIt first, InputIt last, unsigned threads = defaultThreads()) {
+        std::vector<Node *> nodes;
+        bool sorted = true;
+
+        try {
+            for (; first != last; ++first) {
+                auto &&key = *first;
+                if (!nodes.empty() and !less(nodes.back()->key, key)) {
+                    // Doublon consécutif, déjà présent dans le tableau
+                    if (!less(key, nodes.back()->key)) {
+                        setMultiplicity(nodes.back(), multiplicity(nodes.back()) + 1);
+                        continue;
+                    }
+                    sorted = false;
+                }
+                nodes.push_back(nullptr);
+                nodes.back() = createNode(std::forward<decltype(key)>(key));
+            }
+
+            if (!sorted) {
+                sortNodes(nodes.data(), nodes.size(), threads);
+                // Le tri étant stable, on garde la première occurrence de chaque clé
+                size_t kept = 0;
+                for (size_t i = 0; i < nodes.size(); ++i) {
+                    bool duplicate = kept != 0 and !less(nodes[kept - 1]->key, nodes[i]->key);
+                    Node *n = nodes[i];
+                    nodes[i] = nullptr;
+                    if (duplicate) {
+                        setMultiplicity(nodes[kept - 1], multiplicity(nodes[kept - 1]) + multiplicity(n));
+                        destroyNode(n);
+                    } else {
+                        nodes[kept++] = n;
+                    }
+                }
+                nodes.resize(kept);
+            }
+        } catch (...) {
+            for (Node *n : nodes)
+                if (n != nullptr)
+                    destroyNode(n);
+            throw;
+        }
+
+        deleteSubTree(_root);
+        arborize(_root, nodes.data(), nodes.size(), threads);
+    }
+
+private:
+    //
+    // @brief arborise les cnt premiers elements d'une liste en un arbre
+    //
+    // @param tree reference dans laquelle il faut ecrire la racine de l'arbre
+    //             arborise par la fonction
+    // @param list IN - reference a la tete de la liste a parcourir. La liste
+    //                  est composee de Node dont le pointer left est nullptr
+    //             OUT - debut de la suite de la liste dont on a utilise cnt
+    //                   elements
+    // @param cnt  nombre d'elements de la liste que l'on doit utiliser pour
+    //             arboriser le sous arbre
+    //
+    // le parent de la racine produite vaut nullptr, à corriger par l'appelant
+    // si le sous arbre n'est pas l'arbre complet
+    // @Remark Complexité : O(n)
+    //
+    static void arborize(Node *&tree, Node *&list, size_t cnt) noexcept {
+        // Chaque cadre correspond à un sous arbre en construction : on construit d'abord
+        // son sous arbre gauche (cadre enfant), puis on prend la tête de la liste comme
+        // racine, puis on construit son sous arbre droit (cadre enfant).
+        // cnt est au moins divisé par deux à chaque niveau, 65 cadres suffisent donc.
+        struct Frame {
+            Node **slot;  // lien où écrire la racine du sous arbre
+            Node *parent; // parent de la racine du sous arbre (connu pour un sous arbre droit)
+            size_t cnt;   // nombre d'éléments du sous arbre
+            Node *left;   // sous arbre gauche une fois construit
+            int step;     // 0 : gauche à construire, 1 : droite à construire, 2 : terminé
+        };
+        Frame stack[66];
+        size_t top = 0;
+        stack[0] = Frame{&tree, nullptr, cnt, nullptr, 0};
+
+        while (true) {
+            Frame &f = stack[top];
+            if (f.step == 0) {
+                if (f.cnt == 0) {
+                    *f.slot = nullptr;
+                    if (top == 0)
+                        return;
+                    --top;
+                    continue;
+                }
+                // On va d'abord arboriser les sous arbres de gauche, ensuite droite
+                f.step = 1;
+                stack[++top] = Frame{&f.left, nullptr, (f.cnt - 1) / 2, nullptr, 0};
+            } else if (f.step == 1) {
+                Node *r = list;
+                list = list->right;
+                r->left = f.left;
+                setParent(r->left, r);
+                r->parent = f.parent;
+                *f.slot = r;
+                f.step = 2;
+                stack[++top] = Frame{&r->right, r, f.cnt / 2, nullptr, 0};
+            } else {
+                update(*f.slot);
+                if (top == 0)
+                    return;
+                --top;
+            }
+        }
+    }
+
+    // En dessous de ce nombre de noeuds, un sous arbre est traité par un seul thread
+    static const size_t ParallelCutoff = size_t(1) << 14;
+
+    static unsigned defaultThreads() noexcept {
+        unsigned n = std::thread::hardware_concurrency();
+        return n != 0 ? n : 1;
+    }
+
+    /**
+     * @brief Exécute a et b, a dans un nouveau thread si parallel est vrai
+     *
+     * Si le thread ne peut pas être créé, a est exécuté dans le thread appelant.
+     */
+    template<typename FnA, typename FnB>
+    static void forkJoin(bool parallel, FnA &&a, FnB &&b) {
+        std::future<void> fa;
+        if (parallel) {
+            try {
+                fa = std::async(std::launch::async, std::ref(a));
+            } catch (const std::system_error &) {}
+        }
+        if (!fa.valid())
+            a();
+        b();
+        if (fa.valid())
+            fa.get();
+    }
+
+    //
+    // @brief range les noeuds d'un sous arbre par ordre croissant
+    //
+    // @param r la racine du sous arbre
+    // @param out tableau d'au moins nodeCount(r) cases
+    // @param threads nombre de threads disponibles pour ce sous arbre. En
+    //                multiensemble, nbElements ne donne pas la place de chaque
+    //                sous arbre dans out : le parcours est séquentiel
+    // @remark Complexité : O(n)
+    //
+    static void flatten(Node *r, Node **out, unsigned threads) {
+        if (r == nullptr)
+            return;
+        if (!IsMultiset and threads > 1 and r->nbElements >= ParallelCutoff) {
+            size_t left = subtreeSize(r->left);
+            out[left] = r;
+            forkJoin(true, [=] { flatten(r->left, out, threads / 2); },
+                     [=] { flatten(r->right, out + left + 1, threads - threads / 2); });
+            return;
+        }
+
+        size_t i = 0;
+        forEachNode(r, [&](Node *n) { out[i++] = n; });
+    }
+
+    //
+    // @brief nombre de noeuds d'un sous arbre
+    //
+    // @remark Complexité : O(1), O(n) en multiensemble où nbElements compte les
+    //         occurrences et non les noeuds
+    //
+    static size_t nodeCount(Node *r) {
+        if (!IsMultiset)
+            return subtreeSize(r);
+        size_t cnt = 0;
+        forEachNode(r, [&](Node *) { ++cnt; });
+        return cnt;
+    }
+
+    //
+    // @brief arborise un tableau de noeuds tries, en parallele
+    //
+    // Memes decoupes que arborize(Node*&, Node*&, size_t) : le sous arbre gauche
+    // est arborise dans un nouveau thread pendant que le thread courant arborise
+    // le droit. Sous ParallelCutoff noeuds, ou faute de threads, la tranche est
+    // chainee en liste puis arborisee sequentiellement.
+    //
+    // @param tree reference dans laquelle ecrire la racine, dont le parent vaut nullptr
+    // @param nodes les noeuds, par ordre croissant
+    // @param cnt nombre de noeuds
+    // @param threads nombre de threads disponibles
+    // @remark Complexité : O(n)
+    //
+    static void arborize(Node *&tree, Node **nodes, size_t cnt, unsigned threads) {
+        if (threads > 1 and cnt >= ParallelCutoff) {
+            size_t left = (cnt - 1) / 2;
+            Node *r = nodes[left];
+            forkJoin(true, [&] { arborize(r->left, nodes, left, threads / 2); },
+                     [&] { arborize(r->right, nodes + left + 1, cnt / 2, threads - threads / 2); });
+            setParent(r->left, r);
+            setParent(r->right, r);
+            r->parent = nullptr;
+            update(r);
+            tree = r;
+            return;
+        }
+
+        for (size_t i = 0; i + 1 < cnt; ++i)
+            nodes[i]->right = nodes[i + 1];
+        for (size_t i = 0; i < cnt; ++i)
+            nodes[i]->left = nullptr;
+        Node *list = cnt != 0 ? nodes[0] : nullptr;
+        arborize(tree, list, cnt);
+    }
+
+    //
+    // @brief tri stable d'un tableau de noeuds par cle
+    //
+    // Les deux moities sont triees en parallele puis fusionnees.
+    //
+    // @remark Complexité : O(n log(n))
+    //
+    void sortNodes(Node **nodes, size_t cnt, unsigned threads) const {
+        auto byKey = [this](const Node *a, const Node *b) { return less(a->key, b->key); };
+        if (threads <= 1 or cnt < ParallelCutoff) {
+            std::stable_sort(nodes, nodes + cnt, byKey);
+            return;
+        }
+        size_t half = cnt / 2;
+        forkJoin(true, [=] { this->sortNodes(nodes, half, threads / 2); },
+                 [=] { this->sortNodes(nodes + half, cnt - half, threads - threads / 2); });
+        std::inplace_merge(nodes, nodes + half, nodes + cnt, byKey);
+    }
+
+public:
+    //
+    // @brief Parcours pre-ordonne de l'arbre
+    //
+    // @param f une fonction capable d'être appelée en recevant une cle
+    //          en parametre. Pour le noeud n courrant, l'appel sera
+    //          f(n->key), une fois par occurrence de la cle ;
+    //          f est passee par reference, jamais copiee.
+    //
+    // @remark Complexité : O(n)
+    //
+    template<typename Fn>
+    void visitPre(Fn &&f) {
+        visitPre(f, _root);
+    }
+
+    //
+    // @brief Parcours symétrique de l'arbre
+    //
+    // @param f une fonction capable d'être appelée en recevant une cle
+    //          en parametre. Pour le noeud n courrant, l'appel sera
+    //          f(n->key), une fois par occurrence de la cle ;
+    //          f est passee par reference, jamais copiee.
+    // @remark Complexité : O(n)
+    template<typename Fn>
+    void visitSym(Fn &&f) {
+        visitSym(f, _root);
+    }
+
+    //
+    // @brief Parcours post-ordonne de l'arbre
+    //
+    // @param f une fonction capable d'être appelée en recevant une cle
+    //          en parametre. Pour le noeud n courrant, l'appel sera
+    //          f(n->key), une fois par occurrence de la cle ;
+    //          f est passee par reference, jamais copiee.
+    //
+    // @remark Complexité : O(n)
+    template<typename Fn>
+    void visitPost(Fn &&f) {
+        visitPost(f, _root);
+    }
+
+    //
+    // @brief Parcours symétrique de l'arbre, réparti entre plusieurs threads
+    //
+    // Les cles sont decoupees en tranches contigues, une par sous arbre, dont
+    // la taille est connue par nbElements. Chaque tranche est parcourue par
+    // ordre croissant, mais les tranches le sont en meme temps.
+    //
+    // @param f une fonction appelée avec chaque cle, depuis plusieurs threads
+    //          a la fois : elle doit etre thread-safe. Elle est partagee par
+    //          reference entre les threads, jamais copiee.
+    // @param threads nombre maximal de threads a utiliser
+    // @remark Complexité : O(n), O(n / threads + log(n)) en temps ecoule
+    //
+    template<typename Fn>
+    void visitSymParallel(Fn &&f, unsigned threads = defaultThreads()) const {
+        visitSymParallel(f, _root, threads);
+    }
+
+    //
+    // @brief Combine toutes les cles, par ordre croissant, en repartissant le
+    //        travail entre plusieurs threads
+    //
+    // Chaque thread accumule les cles d'une tranche a partir de identity, puis les
+    // resultats partiels sont combines par ordre croissant des tranches :
+    // combine doit etre associative, pas forcement commutative.
+    //
+    // @param identity element neutre de combine
+    // @param combine appelée comme combine(acc, cle) et combine(acc, partiel),
+    //        elle retourne le nouvel accumulateur. Exemple : std::plus<long>()
+    // @param threads nombre maximal de threads a utiliser
+    // @return identity pour un arbre vide
+    // @remark Complexité : O(n), O(n / threads + log(n)) en temps ecoule
+    //
+    template<typename R, typename Combine>
+    R reduce(R identity, Combine combine, unsigned threads = defaultThreads()) const {
+        return mapReduce(identity, combine, combine, threads);
+    }
+
+    //
+    // @brief Comme reduce, avec une fonction pour accumuler les cles et une
+    //        autre pour combiner les resultats partiels (histogrammes, ...)
+    //
+    // @param identity element neutre de merge
+    // @param fold appelée comme fold(acc, cle), retourne le nouvel accumulateur
+    // @param merge appelée comme merge(gauche, droite) sur deux resultats
+    //        partiels de tranches consecutives, doit etre associative
+    // @param threads nombre maximal de threads a utiliser
+    // @remark Complexité : O(n), O(n / threads + log(n)) en temps ecoule
+    //
+    template<typename R, typename Fold, typename Merge>
+    R mapReduce(const R &identity, Fold fold, Merge merge, unsigned threads = defaultThreads()) const {
+        return mapReduce(_root, identity, fold, merge, threads);
+    }
+
+private:
+    //
+    // @brief Parcours pre-ordonne de l'arbre
+    //
+    // @param f une fonction capable d'être appelée en recevant une cle
+    //          en parametre. Pour le noeud n courrant, l'appel sera
+    //          f(n->key);
+    // @param r La racine du sous arbre
+    // @remark Complexité : O(n)
+    //
+    template<typename Fn>
+    static void visitPre(Fn &f, Node *r) {
+        NodeStack<Node *> stack;
+        if (r != nullptr)
+            stack.push(r);
+        while (!stack.empty()) {
+            r = stack.pop();
+            visitCopies(f, r);
+            // Le sous arbre droit est empilé en premier pour visiter le gauche d'abord
+            if (r->right != nullptr)
+                stack.push(r->right);
+            if (r->left != nullptr)
+                stack.push(r->left);
+        }
+    }
+
+    //
+    // @brief Parcours symétrique de l'arbre
+    //
+    // @param f une fonction capable d'être appelée en recevant une cle
+    //          en parametre. Pour le noeud n courrant, l'appel sera
+    //          f(n->key);
+    // @param r La racine du sous arbre
+    // @remark Complexité : O(n)
+    //
+    template<typename Fn>
+    static void visitSym(Fn &f, Node *r) {
+        NodeStack<Node *> stack;
+        while (r != nullptr or !stack.empty()) {
+            // On empile toute la branche gauche avant de visiter
+            while (r != nullptr) {
+                stack.push(r);
+                r = r->left;
+            }
+            r = stack.pop();
+            visitCopies(f, r);
+            r = r->right;
+        }
+    }
+
+    //
+    // @brief Parcours post-ordonne de l'arbre
+    //
+    // @param f une fonction capable d'être appelée en recevant une cle
+    //          en parametre. Pour le noeud n courrant, l'appel sera
+    //          f(n->key);
+    // @param r La racine du sous arbre
+    // @remark Complexité : O(n)
+    //
+    template<typename Fn>
+    static void visitPost(Fn &f, Node *r) {
+        NodeStack<Node *> stack;
+        Node *last = nullptr; // dernier noeud visité
+        while (r != nullptr or !stack.empty()) {
+            while (r != nullptr) {
+                stack.push(r);
+                r = r->left;
+            }
+            Node *top = stack.top();
+            // Le sous arbre droit n'a pas encore été parcouru
+            if (top->right != nullptr and top->right != last) {
+                r = top->right;
+            } else {
+                visitCopies(f, top);
+                last = stack.pop();
+            }
+        }
+    }
+
+    //
+    // @brief Appelle f avec la cle de n, une fois par occurrence
+    //
+    // en clés uniques multiplicity vaut toujours 1 : la boucle disparaît
+    //
+    template<typename Fn>
+    static void visitCopies(Fn &f, const Node *n) {
+        for (size_t copies = multiplicity(n); copies > 0; --copies)
+            f(n->key);
+    }
+
+    //
+    // @brief Parcours symetrique d'un sous arbre par les successeurs, sans pile
+    //
+    // @param r la racine du sous arbre, le parcours n'en sort pas
+    // @param f appelée avec chaque noeud
+    // @remark Complexité : O(n)
+    //
+    template<typename Fn>
+    static void forEachNode(Node *r, Fn &&f) {
+        if (r == nullptr)
+            return;
+        Node *n = leftmost(r);
+        while (true) {
+            Node *next = n->right != nullptr ? leftmost(n->right) : nullptr;
+            // Sans enfant droit, on remonte tant qu'on vient de la droite, sans dépasser r
+            if (next == nullptr) {
+                Node *up = n;
+                while (up != r and up == up->parent->right)
+                    up = up->parent;
+                next = up != r ? up->parent : nullptr;
+            }
+            f(n);
+            if (next == nullptr)
+                return;
+            n = next;
+        }
+    }
+
+    //
+    // @brief nombre de threads attribues au sous arbre gauche de r, en
+    //        proportion de sa taille, au moins un de chaque cote
+    //
+    // @param threads nombre de threads disponibles pour r, au moins 2
+    //
+    static unsigned leftShare(const Node *r, unsigned threads) noexcept {
+        size_t left = subtreeSize(r->left);
+        unsigned share = unsigned(double(threads) * double(left) / double(r->nbElements) + 0.5);
+        return std::min(std::max(share, 1u), threads - 1);
+    }
+
+    template<typename Fn>
+    static void visitSymParallel(Fn &f, Node *r, unsigned threads) {
+        if (r == nullptr)
+            return;
+        if (threads > 1 and r->nbElements >= ParallelCutoff) {
+            unsigned left = leftShare(r, threads);
+            forkJoin(true, [&] { visitSymParallel(f, r->left, left); },
+                     [&] {
+                         visitCopies(f, r);
+                         visitSymParallel(f, r->right, threads - left);
+                     });
             return;
         }
-        linearize(tree->right, list, cnt);
-        // Stock dans l'enfant droit, le noeud de la list et la list contient le noeud courant
-        tree->right = list;
-        list = tree;
-        // Mise à jour du count et du nb des éléments du noeud courant
-        ++cnt;
-        tree->nbElements = cnt;
+        forEachNode(r, [&](Node *n) { visitCopies(f, n); });
+    }
 
-        // à chaque enfant gauche, on ba donné nullptr car on veut un arbre sous forme de liste
-        linearize(tree->left, list, cnt);
-        tree->left = nullptr;
+    template<typename R, typename Fold, typename Merge>
+    static R mapReduce(Node *r, const R &identity, Fold &fold, Merge &merge, unsigned threads) {
+        if (r == nullptr)
+            return identity;
+        if (threads > 1 and r->nbElements >= ParallelCutoff) {
+            unsigned left = leftShare(r, threads);
+            R lo(identity), hi(identity);
+            forkJoin(true, [&] { lo = mapReduce(r->left, identity, fold, merge, left); },
+                     [&] { hi = mapReduce(r->right, identity, fold, merge, threads - left); });
+            R mid(identity);
+            auto accumulate = [&](const_reference key) { mid = fold(std::move(mid), key); };
+            visitCopies(accumulate, r);
+            return merge(merge(std::move(lo), std::move(mid)), std::move(hi));
+        }
+        // L'accumulateur est deplace a chaque etape, pas copie
+        R acc(identity);
+        auto accumulate = [&](const_reference key) { acc = fold(std::move(acc), key); };
+        forEachNode(r, [&](Node *n) { visitCopies(accumulate, n); });
+        return acc;
     }
 
+
 public:
+    /**
+     *  @brief Itérateur bidirectionnel constant parcourant les clés par ordre croissant.
+     *
+     *  Le successeur est trouvé grâce aux liens vers les parents, un parcours
+     *  complet coûte donc O(n), soit O(1) amorti par incrément. Un itérateur reste
+     *  valide tant que le noeud qu'il désigne n'est pas supprimé.
+     *
+     *  Comme std::multiset, un multiensemble présente chaque clé count(key) fois :
+     *  l'itérateur retient l'occurrence courante de son noeud.
+     */
+    class const_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        const_iterator() : _tree(nullptr), _node(nullptr), _copy(0) {}
+
+        reference operator*() const { return _node->key; }
+
+        pointer operator->() const { return &_node->key; }
+
+        const_iterator &operator++() {
+            if (++_copy < multiplicity(_node))
+                return *this;
+            _copy = 0;
+            if (_node->right != nullptr) {
+                _node = leftmost(_node->right);
+            } else {
+                // On remonte tant qu'on vient de la droite
+                Node *child = _node;
+                _node = _node->parent;
+                while (_node != nullptr and child == _node->right) {
+                    child = _node;
+                    _node = _node->parent;
+                }
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        const_iterator &operator--() {
+            if (_node != nullptr and _copy > 0) {
+                --_copy;
+                return *this;
+            }
+            // Depuis end(), on revient sur la plus grande clé
+            if (_node == nullptr) {
+                _node = rightmost(_tree->_root);
+            } else if (_node->left != nullptr) {
+                _node = rightmost(_node->left);
+            } else {
+                // On remonte tant qu'on vient de la gauche
+                Node *child = _node;
+                _node = _node->parent;
+                while (_node != nullptr and child == _node->left) {
+                    child = _node;
+                    _node = _node->parent;
+                }
+            }
+            // On arrive sur la dernière occurrence du prédécesseur
+            _copy = multiplicity(_node) - 1;
+            return *this;
+        }
+
+        const_iterator operator--(int) {
+            const_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        bool operator==(const const_iterator &other) const {
+            return _node == other._node and _copy == other._copy;
+        }
+
+        bool operator!=(const const_iterator &other) const { return !(*this == other); }
+
+    private:
+        friend class BinarySearchTree;
+
+        const_iterator(const BinarySearchTree *tree, Node *node) : _tree(tree), _node(node), _copy(0) {}
+
+        const BinarySearchTree *_tree; // arbre parcouru, nécessaire pour décrémenter end()
+        Node *_node;                   // noeud courant, nullptr pour end()
+        size_t _copy;                  // occurrence courante de la clé de _node, 0 en clés uniques
+    };
+
+    using iterator = const_iterator;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using reverse_iterator = const_reverse_iterator;
+
     //
-    // @brief equilibre l'arbre
+    // @brief Itérateur sur la plus petite clé, end() si l'arbre est vide
+    // @remark Complexité moyenne : O(log(n))
     //
-    // applique l'algorithme d'equilibrage de l'arbre par linearisation et
-    // arborisation
+    const_iterator begin() const noexcept {
+        return const_iterator(this, leftmost(_root));
+    }
+
     //
-    // Ne pas modifier cette fonction.
+    // @brief Itérateur suivant la plus grande clé
+    // @remark Complexité : O(1)
     //
-    void balance() noexcept {
-        size_t cnt = 0;
-        Node *list = nullptr;
-        linearize(_root, list, cnt);
-        arborize(_root, list, cnt);
+    const_iterator end() const noexcept {
+        return const_iterator(this, nullptr);
     }
 
-private:
+    const_iterator cbegin() const noexcept { return begin(); }
+
+    const_iterator cend() const noexcept { return end(); }
+
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
     //
-    // @brief arborise les cnt premiers elements d'une liste en un arbre
+    // @brief Recherche d'une cle
+    // @param key la cle a rechercher
+    // @return un itérateur sur la cle, end() si elle est absente
+    // @remark Complexité moyenne : O(log(n))
     //
-    // @param tree reference dans laquelle il faut ecrire la racine de l'arbre
-    //             arborise par la fonction
-    // @param list IN - reference a la tete de la liste a parcourir. La liste
-    //                  est composee de Node dont le pointer left est nullptr
-    //             OUT - debut de la suite de la liste dont on a utilise cnt
-    //                   elements
-    // @param cnt  nombre d'elements de la liste que l'on doit utiliser pour
-    //             arboriser le sous arbre
-    // @Remark Complexité : O(n)
+    const_iterator find(const_reference key) const noexcept {
+        return const_iterator(this, findNode(_root, key));
+    }
+
+    // recherche hétérogène, voir contains
+    template<typename K, typename = EnableIfLookup<K>>
+    const_iterator find(const K &key) const noexcept {
+        return const_iterator(this, findNode(_root, key));
+    }
+
     //
-    static void arborize(Node *&tree, Node *&list, size_t cnt) noexcept {
-        if(cnt == 0){
-            tree = nullptr;
-            return;
-        }
-        // On va d'abord arboriser les sous arbres de gauche, ensuite droite
-        Node* rg = nullptr;
-        arborize(rg, list, (cnt-1)/2);
-        tree = list;
-        tree->left = rg;
-        list = list->right;
-        tree->nbElements = cnt;
-        arborize(tree->right, list, cnt/2);
+    // @brief Insertion d'une cle construite sur place, seulement si key est absente
+    //
+    // @param key la cle cherchée, de type T ou d'un type de recherche hétérogène
+    // @param args les arguments du constructeur de la clé. La clé construite doit
+    //             être équivalente à key. Rien n'est construit si key est présente
+    // @return un itérateur sur la cle de l'arbre, et vrai si elle vient d'être insérée
+    // @remark Complexité moyenne : O(log(n)), une seule descente
+    //
+    template<typename K, typename... Args>
+    std::pair<const_iterator, bool> tryEmplace(const K &key, Args &&... args) {
+        std::pair<Node *, bool> found = insert(_root, key, [&] { return createNode(std::forward<Args>(args)...); });
+        return std::make_pair(const_iterator(this, found.first), found.second);
     }
 
-public:
     //
-    // @brief Parcours pre-ordonne de l'arbre
+    // @brief Première cle qui n'est pas plus petite que key
+    // @param key la borne
+    // @return un itérateur sur cette cle, end() si toutes sont plus petites
+    // @remark Complexité moyenne : O(log(n))
     //
-    // @param f une fonction capable d'être appelée en recevant une cle
-    //          en parametre. Pour le noeud n courrant, l'appel sera
-    //          f(n->key);
+    const_iterator lower_bound(const_reference key) const noexcept {
+        return const_iterator(this, lowerBoundNode(_root, key));
+    }
+
+    // recherche hétérogène, voir contains
+    template<typename K, typename = EnableIfLookup<K>>
+    const_iterator lower_bound(const K &key) const noexcept {
+        return const_iterator(this, lowerBoundNode(_root, key));
+    }
+
     //
-    // @remark Complexité : O(n)
+    // @brief Première cle strictement plus grande que key
+    // @param key la borne
+    // @return un itérateur sur cette cle, end() si aucune n'est plus grande
+    // @remark Complexité moyenne : O(log(n))
     //
-    template<typename Fn>
-    void visitPre(Fn f) {
-        visitPre(f, _root);
+    const_iterator upper_bound(const_reference key) const noexcept {
+        return const_iterator(this, upperBoundNode(_root, key));
+    }
+
+    // recherche hétérogène, voir contains
+    template<typename K, typename = EnableIfLookup<K>>
+    const_iterator upper_bound(const K &key) const noexcept {
+        return const_iterator(this, upperBoundNode(_root, key));
     }
 
     //
-    // @brief Parcours symétrique de l'arbre
+    // @brief Nombre de cles dans l'intervalle [lo, hi)
     //
-    // @param f une fonction capable d'être appelée en recevant une cle
-    //          en parametre. Pour le noeud n courrant, l'appel sera
-    //          f(n->key);
-    // @remark Complexité : O(n)
-    template<typename Fn>
-    void visitSym(Fn f) {
-        visitSym(f, _root);
+    // @param lo borne inférieure, incluse
+    // @param hi borne supérieure, exclue
+    //
+    // @return le nombre de cles k telles que lo <= k < hi, 0 si hi <= lo
+    //
+    // utilise nbElements : deux descentes suffisent, sans visiter les cles
+    // @remark Complexité moyenne : O(log(n))
+    //
+    size_t countRange(const_reference lo, const_reference hi) const noexcept {
+        if (!less(lo, hi))
+            return 0;
+        return countLess(_root, hi) - countLess(_root, lo);
+    }
+
+    // recherche hétérogène, voir contains. Les deux bornes sont du même type K
+    template<typename K, typename = EnableIfLookup<K>>
+    size_t countRange(const K &lo, const K &hi) const noexcept {
+        size_t below = countLess(_root, lo), under = countLess(_root, hi);
+        return under > below ? under - below : 0;
     }
 
     //
-    // @brief Parcours post-ordonne de l'arbre
+    // @brief Parcours symétrique des cles de l'intervalle [lo, hi)
     //
+    // @param lo borne inférieure, incluse
+    // @param hi borne supérieure, exclue
     // @param f une fonction capable d'être appelée en recevant une cle
-    //          en parametre. Pour le noeud n courrant, l'appel sera
-    //          f(n->key);
+    //          en parametre, une fois par occurrence
+    //
+    // seuls les noeuds du chemin vers lo et ceux de l'intervalle sont visités
+    // @remark Complexité moyenne : O(log(n) + k), k le nombre de cles visitées
     //
-    // @remark Complexité : O(n)
     template<typename Fn>
-    void visitPost(Fn f) {
-        visitPost(f, _root);
+    void forEachInRange(const_reference lo, const_reference hi, Fn &&f) const {
+        for (const_iterator it = lower_bound(lo); it != end() and less(*it, hi); ++it)
+            f(*it);
     }
 
-private:
     //
-    // @brief Parcours pre-ordonne de l'arbre
+    // @brief Résumé de toutes les cles selon la politique d'augmentation
     //
-    // @param f une fonction capable d'être appelée en recevant une cle
-    //          en parametre. Pour le noeud n courrant, l'appel sera
-    //          f(n->key);
-    // @param r La racine du sous arbre
-    // @remark Complexité : O(n)
+    // @return Augment::identity() si l'arbre est vide
+    // @remark Complexité : O(1)
     //
-    template<typename Fn>
-    static void visitPre(Fn f, Node *r) {
-        if (r != nullptr) {
-            f(r->key);
-            visitPre(f, r->left);
-            visitPre(f, r->right);
-        }
+    summary_type aggregate() const {
+        return summaryOf(_root);
     }
 
     //
-    // @brief Parcours symétrique de l'arbre
+    // @brief Résumé des cles de l'intervalle [lo, hi), combinées dans l'ordre croissant
     //
-    // @param f une fonction capable d'être appelée en recevant une cle
-    //          en parametre. Pour le noeud n courrant, l'appel sera
-    //          f(n->key);
-    // @param r La racine du sous arbre
-    // @remark Complexité : O(n)
+    // @param lo borne inférieure, incluse
+    // @param hi borne supérieure, exclue
     //
-    template<typename Fn>
-    void visitSym(Fn f, Node *r) {
-        if (r != nullptr) {
-            visitSym(f, r->left);
-            f(r->key);
-            visitSym(f, r->right);
+    // @return Augment::identity() si l'intervalle est vide
+    //
+    // On descend jusqu'au premier noeud de l'intervalle rencontré, puis le long
+    // des chemins vers lo et vers hi : les sous arbres entièrement compris dans
+    // l'intervalle ne sont pas visités, leur résumé suffit.
+    // @remark Complexité moyenne : O(log(n))
+    //
+    summary_type aggregate(const_reference lo, const_reference hi) const {
+        return aggregate(_root, lo, hi);
+    }
+
+    // recherche hétérogène, voir contains. Les deux bornes sont du même type K
+    template<typename K, typename = EnableIfLookup<K>>
+    summary_type aggregate(const K &lo, const K &hi) const {
+        return aggregate(_root, lo, hi);
+    }
+
+private:
+    template<typename K>
+    summary_type aggregate(Node *r, const K &lo, const K &hi) const {
+        using A = Augment;
+        // Premier noeud dont la clé est dans l'intervalle : lo et hi se séparent en dessous
+        while (r != nullptr) {
+            if (less(r->key, lo))
+                r = r->right;
+            else if (!less(r->key, hi))
+                r = r->left;
+            else
+                break;
+        }
+        if (r == nullptr)
+            return A::identity();
+
+        // A gauche, les clés >= lo, accumulées de la droite vers la gauche
+        summary_type below = A::identity();
+        for (Node *n = r->left; n != nullptr;) {
+            if (less(n->key, lo)) {
+                n = n->right;
+            } else {
+                below = A::combine(measureCopies<A>(n), A::combine(summaryOf(n->right), below));
+                n = n->left;
+            }
+        }
+
+        // A droite, les clés < hi, accumulées de la gauche vers la droite
+        summary_type above = A::identity();
+        for (Node *n = r->right; n != nullptr;) {
+            if (less(n->key, hi)) {
+                above = A::combine(A::combine(above, summaryOf(n->left)), measureCopies<A>(n));
+                n = n->right;
+            } else {
+                n = n->left;
+            }
+        }
+        return A::combine(A::combine(below, measureCopies<A>(r)), above);
+    }
+
+    // Résumé d'un sous arbre, Augment::identity() s'il est vide
+    static summary_type summaryOf(const Node *r) {
+        static_assert(!std::is_same<Augment, NoAugment>::value, "aggregate demande une politique d'augmentation");
+        return r != nullptr ? r->summary : Augment::identity();
+    }
+
+    /**
+     * @brief Nombre de clés strictement plus petites que key dans un sous arbre
+     * @param r La racine du sous arbre, peut valoir nullptr
+     * @param key La borne, pas forcément présente dans l'arbre
+     * @remark Complexité moyenne : O(log(n))
+     */
+    template<typename K>
+    size_t countLess(Node *r, const K &key) const noexcept {
+        size_t smaller = 0;
+        while (r != nullptr) {
+            if (less(r->key, key)) {
+                smaller += subtreeSize(r->left) + multiplicity(r);
+                r = r->right;
+            } else {
+                r = r->left;
+            }
+        }
+        return smaller;
+    }
+
+    /**
+     * @brief Noeud de clé key dans un sous arbre
+     * @return le noeud, nullptr si la clé est absente
+     * @remark Complexité moyenne : O(log(n))
+     */
+    template<typename K>
+    Node *findNode(Node *r, const K &key) const noexcept {
+        while (r != nullptr) {
+            int c = compare(key, r->key);
+            if (c < 0)
+                r = r->left;
+            else if (c > 0)
+                r = r->right;
+            else
+                break;
+        }
+        return r;
+    }
+
+    /**
+     * @brief Premier noeud dont la clé n'est pas plus petite que key, nullptr s'il n'y en a pas
+     * @remark Complexité moyenne : O(log(n))
+     */
+    template<typename K>
+    Node *lowerBoundNode(Node *r, const K &key) const noexcept {
+        Node *candidate = nullptr;
+        while (r != nullptr) {
+            if (less(r->key, key)) {
+                r = r->right;
+            } else {
+                candidate = r;
+                r = r->left;
+            }
+        }
+        return candidate;
+    }
+
+    /**
+     * @brief Premier noeud dont la clé est strictement plus grande que key, nullptr s'il n'y en a pas
+     * @remark Complexité moyenne : O(log(n))
+     */
+    template<typename K>
+    Node *upperBoundNode(Node *r, const K &key) const noexcept {
+        Node *candidate = nullptr;
+        while (r != nullptr) {
+            if (less(key, r->key)) {
+                candidate = r;
+                r = r->left;
+            } else {
+                r = r->right;
+            }
         }
+        return candidate;
+    }
+
+    /**
+     * @brief Noeud le plus à gauche d'un sous arbre
+     * @param r La racine du sous arbre, peut valoir nullptr
+     * @remark Complexité moyenne : O(log(n))
+     */
+    static Node *leftmost(Node *r) noexcept {
+        if (r != nullptr)
+            while (r->left != nullptr)
+                r = r->left;
+        return r;
+    }
+
+    /**
+     * @brief Noeud le plus à droite d'un sous arbre
+     * @param r La racine du sous arbre, peut valoir nullptr
+     * @remark Complexité moyenne : O(log(n))
+     */
+    static Node *rightmost(Node *r) noexcept {
+        if (r != nullptr)
+            while (r->right != nullptr)
+                r = r->right;
+        return r;
     }
 
+public:
     //
-    // @brief Parcours post-ordonne de l'arbre
+    // @brief Exporte la structure de l'arbre au format Graphviz DOT
     //
-    // @param f une fonction capable d'être appelée en recevant une cle
-    //          en parametre. Pour le noeud n courrant, l'appel sera
-    //          f(n->key);
-    // @param r La racine du sous arbre
-    // @remark Complexité : O(n)
+    // @param os le flux, écrit au fur et à mesure
+    // @param maxDepth profondeur maximale des noeuds exportés, la racine est à 0
     //
-    template<typename Fn>
-    void visitPost(Fn f, Node *r) {
-        if (r != nullptr) {
-            visitPost(f, r->left);
-            visitPost(f, r->right);
-            f(r->key);
+    // Chaque noeud est identifié par le rang de sa cle (n<rang>) et étiqueté par
+    // sa cle et son nbElements. Contrairement à display, rien n'est accumulé en
+    // mémoire et les sous arbres vides ne coûtent rien.
+    // @remark Complexité : O(k) en temps pour k noeuds exportés, O(log(n)) en mémoire
+    //
+    void exportDot(std::ostream &os, size_t maxDepth = size_t(-1)) const {
+        exportDot(os, nullptr, nullptr, maxDepth);
+    }
+
+    //
+    // @brief Comme exportDot(os, maxDepth), limité aux cles de l'intervalle [lo, hi)
+    //
+    // Seuls les noeuds du chemin vers l'intervalle et ceux de l'intervalle sont visités.
+    //
+    void exportDot(std::ostream &os, const_reference lo, const_reference hi, size_t maxDepth = size_t(-1)) const {
+        exportDot(os, &lo, &hi, maxDepth);
+    }
+
+    //
+    // @brief Exporte la structure de l'arbre en JSON, un objet par ligne et par noeud
+    //
+    // @param os le flux, écrit au fur et à mesure
+    // @param maxDepth profondeur maximale des noeuds exportés, la racine est à 0
+    //
+    // Chaque ligne est de la forme
+    //   {"id":3,"key":7,"depth":1,"size":4,"parent":5,"left":2,"right":4}
+    // où id est le rang de la cle ; parent, left et right valent null en l'absence
+    // du noeud correspondant, qui n'est pas forcément exporté. Les lignes ne
+    // suivent pas un ordre de parcours particulier.
+    // @remark Complexité : O(k) en temps pour k noeuds exportés, O(log(n)) en mémoire
+    //
+    void exportJsonLines(std::ostream &os, size_t maxDepth = size_t(-1)) const {
+        exportJsonLines(os, nullptr, nullptr, maxDepth);
+    }
+
+    //
+    // @brief Comme exportJsonLines(os, maxDepth), limité aux cles de l'intervalle [lo, hi)
+    //
+    void exportJsonLines(std::ostream &os, const_reference lo, const_reference hi,
+                         size_t maxDepth = size_t(-1)) const {
+        exportJsonLines(os, &lo, &hi, maxDepth);
+    }
+
+private:
+    /**
+     * @brief Noeud rencontré par exportNodes
+     */
+    struct ExportedNode {
+        const Node *node;
+        size_t id;         // rang de la clé
+        size_t depth;
+        size_t parent;     // rang de la clé du parent, s'il existe
+    };
+
+    /**
+     * @brief Visite les noeuds de profondeur <= maxDepth dont la clé est dans [*lo, *hi)
+     *
+     * Des deux sous arbres d'un noeud, on poursuit par le plus petit et on met le
+     * plus grand en attente : chaque sous arbre en attente est plus grand que
+     * tout ce qui reste à visiter avant lui, il y en a donc au plus log2(n) + 1,
+     * quelle que soit la forme de l'arbre.
+     *
+     * @param lo, hi les bornes de l'intervalle, nullptr pour ne pas limiter
+     * @param visit appelée avec chaque ExportedNode
+     * @remark Complexité : O(k + h) en temps, O(log(n)) en mémoire
+     */
+    template<typename Visit>
+    void exportNodes(const value_type *lo, const value_type *hi, size_t maxDepth, Visit visit) const {
+        struct Frame {
+            const Node *node;
+            size_t before;   // nombre de clés plus petites que celles du sous arbre
+            size_t depth;
+        };
+        NodeStack<Frame> stack;
+        if (_root != nullptr)
+            stack.push(Frame{_root, 0, 0});
+
+        while (!stack.empty()) {
+            Frame f = stack.pop();
+            const Node *r = f.node;
+            size_t id = f.before + subtreeSize(r->left);
+            bool aboveLo = lo == nullptr or !less(r->key, *lo);
+            bool belowHi = hi == nullptr or less(r->key, *hi);
+
+            if (aboveLo and belowHi) {
+                size_t parent = size_t(-1);
+                if (r->parent != nullptr)
+                    parent = r->parent->left == r ? id + multiplicity(r) + subtreeSize(r->right)
+                                                  : id - subtreeSize(r->left) - multiplicity(r->parent);
+                visit(ExportedNode{r, id, f.depth, parent});
+            }
+            if (f.depth == maxDepth)
+                continue;
+
+            Frame left{r->left, f.before, f.depth + 1};
+            Frame right{r->right, id + multiplicity(r), f.depth + 1};
+            bool goLeft = r->left != nullptr and aboveLo;
+            bool goRight = r->right != nullptr and belowHi;
+            if (goLeft and goRight) {
+                // Le plus petit est empilé en dernier, donc traité en premier
+                bool leftSmaller = subtreeSize(r->left) < subtreeSize(r->right);
+                stack.push(leftSmaller ? right : left);
+                stack.push(leftSmaller ? left : right);
+            } else if (goLeft) {
+                stack.push(left);
+            } else if (goRight) {
+                stack.push(right);
+            }
+        }
+    }
+
+    void exportDot(std::ostream &os, const value_type *lo, const value_type *hi, size_t maxDepth) const {
+        os << "digraph BinarySearchTree {\n";
+        os << "    node [shape=box];\n";
+        exportNodes(lo, hi, maxDepth, [&](const ExportedNode &e) {
+            os << "    n" << e.id << " [label=\"";
+            writeEscaped(os, e.node->key);
+            os << "\\n" << e.node->nbElements << "\"];\n";
+            // L'arc n'est écrit que si le parent est exporté lui aussi
+            if (e.parent != size_t(-1)
+                and (lo == nullptr or !less(e.node->parent->key, *lo))
+                and (hi == nullptr or less(e.node->parent->key, *hi)))
+                os << "    n" << e.parent << " -> n" << e.id << ";\n";
+        });
+        os << "}\n";
+    }
+
+    void exportJsonLines(std::ostream &os, const value_type *lo, const value_type *hi, size_t maxDepth) const {
+        exportNodes(lo, hi, maxDepth, [&](const ExportedNode &e) {
+            const Node *r = e.node;
+            os << "{\"id\":" << e.id << ",\"key\":";
+            writeJson(os, r->key);
+            os << ",\"depth\":" << e.depth << ",\"size\":" << r->nbElements << ",\"parent\":";
+            writeId(os, e.parent);
+            os << ",\"left\":";
+            writeId(os, r->left != nullptr ? e.id - subtreeSize(r->left->right) - multiplicity(r->left) : size_t(-1));
+            os << ",\"right\":";
+            writeId(os, r->right != nullptr ? e.id + multiplicity(r) + subtreeSize(r->right->left) : size_t(-1));
+            os << "}\n";
+        });
+    }
+
+    static void writeId(std::ostream &os, size_t id) {
+        if (id == size_t(-1))
+            os << "null";
+        else
+            os << id;
+    }
+
+    // Ecrit une clé entre guillemets, en échappant les caractères de contrôle, " et \ (JSON et DOT)
+    template<typename K>
+    static void writeEscaped(std::ostream &os, const K &key) {
+        std::ostringstream text;
+        text << key;
+        for (char c : text.str()) {
+            if (c == '"' or c == '\\')
+                os << '\\' << c;
+            else if (c == '\n')
+                os << "\\n";
+            else if ((unsigned char) c < 0x20)
+                os << ' ';
+            else
+                os << c;
         }
     }
 
+    template<typename K>
+    static typename std::enable_if<std::is_arithmetic<K>::value>::type writeJson(std::ostream &os, const K &key) {
+        os << +key;
+    }
+
+    template<typename K>
+    static typename std::enable_if<!std::is_arithmetic<K>::value>::type writeJson(std::ostream &os, const K &key) {
+        os << '"';
+        writeEscaped(os, key);
+        os << '"';
+    }
 
 public:
     //
@@ -850,3 +4115,26 @@ public:
         }
     }
 };
+
+/**
+ *  @brief Arbre binaire de recherche auto-équilibré (AVL), même interface que BinarySearchTree
+ */
+template<typename T, typename Allocator = std::allocator<T>, typename Tracer = NoTrace, typename Compare = ThreeWayLess,
+        typename Augment = NoAugment>
+using AVLTree = BinarySearchTree<T, AVLBalance, Allocator, Tracer, Compare, Augment>;
+
+/**
+ *  @brief Arbre bouc émissaire : équilibré par reconstruction des sous arbres trop lourds d'un côté
+ */
+template<typename T, typename Allocator = std::allocator<T>, typename Tracer = NoTrace, typename Compare = ThreeWayLess,
+        typename Augment = NoAugment>
+using ScapegoatTree = BinarySearchTree<T, ScapegoatBalance, Allocator, Tracer, Compare, Augment>;
+
+/**
+ *  @brief Multiensemble : une clé peut être présente plusieurs fois, voir MultipleKeys
+ */
+template<typename T, typename Balance = NoBalance, typename Allocator = std::allocator<T>, typename Tracer = NoTrace,
+        typename Compare = ThreeWayLess, typename Augment = NoAugment>
+using BinarySearchMultiset = BinarySearchTree<T, Balance, Allocator, Tracer, Compare, Augment, MultipleKeys>;
+
+#endif // BINARY_SEARCH_TREE_H
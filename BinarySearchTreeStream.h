@@ -0,0 +1,282 @@
+/**
+-----------------------------------------------------------------------------------
+Laboratoire : 09
+\file       BinarySearchTreeStream.h
+\author     Loïc Dessaules, Doran Kayoumi, Gabrielle Thurnherr
+\date       16/10/2026
+\brief      Format de flux des arbres binaires de recherche : clés en ordre
+            croissant, découpées en blocs protégés par une somme de contrôle
+Compilateur MinGW-gcc 6.3.0
+
+Copyright (c) 2017 Olivier Cuisenaire. All rights reserved.
+**/
+
+#ifndef BINARY_SEARCH_TREE_STREAM_H
+#define BINARY_SEARCH_TREE_STREAM_H
+
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ *  @brief Encodage d'une clé dans un flux.
+ *
+ *  encode ajoute les octets de key à la fin de out. decode relit une clé à
+ *  partir de p, qu'il avance, sans dépasser end, et rend faux si les octets
+ *  manquent. A spécialiser pour les autres types de clés.
+ *
+ *  Par défaut, les clés trivialement copiables sont copiées octet par octet :
+ *  le flux n'est relisible que sur une machine de même boutisme, ce que
+ *  l'en-tête permet de vérifier.
+ */
+template<typename T, typename Enable = void>
+struct KeyCodec;
+
+template<typename T>
+struct KeyCodec<T, typename std::enable_if<std::is_trivially_copyable<T>::value>::type> {
+    static const uint32_t FixedSize = sizeof(T); // taille de chaque clé, 0 si elle varie
+
+    static void encode(const T &key, std::vector<char> &out) {
+        const char *bytes = reinterpret_cast<const char *>(&key);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    static bool decode(const char *&p, const char *end, T &key) {
+        if (size_t(end - p) < sizeof(T))
+            return false;
+        std::memcpy(&key, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+};
+
+/**
+ *  @brief Chaînes : longueur sur 64 bits puis les caractères
+ */
+template<>
+struct KeyCodec<std::string> {
+    static const uint32_t FixedSize = 0;
+
+    static void encode(const std::string &key, std::vector<char> &out) {
+        uint64_t length = key.size();
+        KeyCodec<uint64_t>::encode(length, out);
+        out.insert(out.end(), key.begin(), key.end());
+    }
+
+    static bool decode(const char *&p, const char *end, std::string &key) {
+        uint64_t length;
+        if (!KeyCodec<uint64_t>::decode(p, end, length) or uint64_t(end - p) < length)
+            return false;
+        key.assign(p, size_t(length));
+        p += length;
+        return true;
+    }
+};
+
+/**
+ *  @brief Somme de contrôle CRC-32 (polynôme IEEE 802.3), celle de zlib. Membre
+ *         d'une structure pour ne pas entrer en conflit avec le crc32 de zlib.
+ */
+struct StreamChecksum {
+    static uint32_t crc32(const char *data, size_t length, uint32_t crc = 0) noexcept {
+        struct Table {
+            uint32_t entries[256];
+
+            Table() {
+                for (uint32_t i = 0; i < 256; ++i) {
+                    uint32_t c = i;
+                    for (int k = 0; k < 8; ++k)
+                        c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                    entries[i] = c;
+                }
+            }
+        };
+        static const Table table;
+
+        crc = ~crc;
+        for (size_t i = 0; i < length; ++i)
+            crc = table.entries[(crc ^ uint8_t(data[i])) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+};
+
+/**
+ *  @brief En-tête d'un flux. Il est suivi de blocs (StreamChunkHeader puis les
+ *         clés encodées), terminés par un bloc vide.
+ */
+struct StreamHeader {
+    char magic[8];        // "BSTSTRM"
+    uint32_t version;
+    uint32_t byteOrder;   // StreamByteOrder, tel que rangé par la machine qui a écrit
+    uint32_t keySize;     // KeyCodec<T>::FixedSize
+    uint32_t crc;         // crc32 de l'en-tête, calculé avec ce champ à 0
+    uint64_t count;       // nombre total de clés
+};
+
+struct StreamChunkHeader {
+    uint32_t keys;        // nombre de clés du bloc, 0 pour le bloc final
+    uint32_t bytes;       // taille des clés encodées
+    uint32_t crc;         // crc32 des clés encodées
+};
+
+static const char StreamMagic[8] = "BSTSTRM";
+static const uint32_t StreamVersion = 2;
+static const uint32_t StreamByteOrder = 0x01020304;
+static const size_t StreamChunkBytes = size_t(1) << 16;           // taille visée d'un bloc
+static const size_t StreamMaxChunkBytes = 4 * StreamChunkBytes;  // au delà, le bloc est jugé corrompu
+
+/**
+ *  @brief crc32 d'un en-tête, son champ crc compté comme nul
+ */
+inline uint32_t streamHeaderCrc(StreamHeader header) noexcept {
+    header.crc = 0;
+    return StreamChecksum::crc32(reinterpret_cast<const char *>(&header), sizeof header);
+}
+
+/**
+ *  @brief Ecrit les clés d'un flux en blocs d'environ StreamChunkBytes octets
+ *
+ *  Seul le bloc en cours est gardé en mémoire. Un bloc ne dépasse jamais
+ *  StreamMaxChunkBytes : une clé encodée sur plus de 3 * StreamChunkBytes
+ *  octets peut donc être refusée.
+ */
+template<typename T>
+class StreamChunkWriter {
+public:
+    StreamChunkWriter(std::ostream &out, uint64_t count) : _out(out), _keys(0) {
+        StreamHeader header;
+        std::memset(&header, 0, sizeof header);
+        std::memcpy(header.magic, StreamMagic, sizeof header.magic);
+        header.version = StreamVersion;
+        header.byteOrder = StreamByteOrder;
+        header.keySize = KeyCodec<T>::FixedSize;
+        header.count = count;
+        header.crc = streamHeaderCrc(header);
+        _out.write(reinterpret_cast<const char *>(&header), sizeof header);
+        _chunk.reserve(StreamChunkBytes);
+    }
+
+    void push(const T &key) {
+        KeyCodec<T>::encode(key, _chunk);
+        ++_keys;
+        if (_chunk.size() >= StreamChunkBytes)
+            flush();
+    }
+
+    /**
+     * @brief Ecrit le dernier bloc et le bloc final
+     * @exception std::runtime_error si le flux est en erreur
+     */
+    void finish() {
+        flush();
+        StreamChunkHeader end = {0, 0, 0};
+        _out.write(reinterpret_cast<const char *>(&end), sizeof end);
+        _out.flush();
+        if (!_out)
+            throw std::runtime_error("Erreur d'ecriture du flux");
+    }
+
+private:
+    void flush() {
+        if (_keys == 0)
+            return;
+        if (_chunk.size() > StreamMaxChunkBytes)
+            throw std::runtime_error("Cle trop grande pour un bloc");
+        StreamChunkHeader header = {_keys, uint32_t(_chunk.size()), StreamChecksum::crc32(_chunk.data(), _chunk.size())};
+        _out.write(reinterpret_cast<const char *>(&header), sizeof header);
+        _out.write(_chunk.data(), std::streamsize(_chunk.size()));
+        _chunk.clear();
+        _keys = 0;
+    }
+
+    std::ostream &_out;
+    std::vector<char> _chunk;
+    uint32_t _keys;
+};
+
+/**
+ *  @brief Relit un flux écrit par StreamChunkWriter, clé par clé
+ *
+ *  L'en-tête est vérifié dès la construction, avant toute clé. Chaque bloc est
+ *  vérifié (taille, somme de contrôle) avant que ses clés ne soient rendues.
+ *  Seul le bloc en cours est gardé en mémoire, au plus StreamMaxChunkBytes octets
+ *  même si le flux est corrompu.
+ */
+template<typename T>
+class StreamChunkReader {
+public:
+    /**
+     * @exception std::runtime_error si l'en-tête est corrompu ou ne décrit pas un
+     *            flux de clés T compatible
+     */
+    explicit StreamChunkReader(std::istream &in) : _in(in), _p(nullptr), _end(nullptr), _left(0), _read(0) {
+        if (!_in.read(reinterpret_cast<char *>(&_header), sizeof _header))
+            throw std::runtime_error("Flux tronque");
+        if (std::memcmp(_header.magic, StreamMagic, sizeof _header.magic) != 0 or _header.version != StreamVersion)
+            throw std::runtime_error("Format de flux inconnu");
+        if (streamHeaderCrc(_header) != _header.crc)
+            throw std::runtime_error("En-tete de flux corrompu");
+        if (_header.byteOrder != StreamByteOrder or _header.keySize != KeyCodec<T>::FixedSize)
+            throw std::runtime_error("Flux ecrit pour une autre machine ou un autre type de cle");
+    }
+
+    uint64_t count() const noexcept {
+        return _header.count;
+    }
+
+    /**
+     * @brief Lit la clé suivante
+     * @return faux après la dernière clé
+     * @exception std::runtime_error si le flux est tronqué ou corrompu
+     */
+    bool next(T &key) {
+        while (_left == 0) {
+            if (!readChunk())
+                return false;
+        }
+        if (!KeyCodec<T>::decode(_p, _end, key))
+            throw std::runtime_error("Bloc corrompu");
+        if (--_left == 0 and _p != _end)
+            throw std::runtime_error("Bloc corrompu");
+        ++_read;
+        return true;
+    }
+
+private:
+    bool readChunk() {
+        StreamChunkHeader header;
+        if (!_in.read(reinterpret_cast<char *>(&header), sizeof header))
+            throw std::runtime_error("Flux tronque");
+        if (header.keys == 0) {
+            if (header.bytes != 0 or header.crc != 0 or _read != _header.count)
+                throw std::runtime_error("Flux corrompu");
+            return false;
+        }
+        if (header.bytes > StreamMaxChunkBytes)
+            throw std::runtime_error("Bloc corrompu");
+        _chunk.resize(header.bytes);
+        if (!_in.read(_chunk.data(), std::streamsize(header.bytes)))
+            throw std::runtime_error("Flux tronque");
+        if (StreamChecksum::crc32(_chunk.data(), _chunk.size()) != header.crc)
+            throw std::runtime_error("Somme de controle incorrecte");
+        _p = _chunk.data();
+        _end = _p + _chunk.size();
+        _left = header.keys;
+        return true;
+    }
+
+    std::istream &_in;
+    StreamHeader _header;
+    std::vector<char> _chunk;
+    const char *_p, *_end;  // clés encodées restantes du bloc en cours
+    uint32_t _left;         // nombre de clés restantes du bloc en cours
+    uint64_t _read;         // nombre de clés rendues
+};
+
+#endif // BINARY_SEARCH_TREE_STREAM_H
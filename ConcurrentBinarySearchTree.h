@@ -0,0 +1,537 @@
+/**
+-----------------------------------------------------------------------------------
+Laboratoire : 09
+\file       ConcurrentBinarySearchTree.h
+\author     Loïc Dessaules, Doran Kayoumi, Gabrielle Thurnherr
+\date       16/10/2026
+\brief      Arbre binaire de recherche partagé entre plusieurs lecteurs et un
+            écrivain : les lectures se font sans verrou
+Compilateur MinGW-gcc 6.3.0
+
+Copyright (c) 2017 Olivier Cuisenaire. All rights reserved.
+**/
+
+#ifndef CONCURRENT_BINARY_SEARCH_TREE_H
+#define CONCURRENT_BINARY_SEARCH_TREE_H
+
+#include <cstdlib>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+/**
+ *  @brief Arbre AVL dont les lectures (contains, min, nth_element, rank, size)
+ *         n'utilisent aucun verrou.
+ *
+ *  Un noeud publié n'est jamais modifié. Un écrivain (les écritures sont
+ *  sérialisées par un mutex) copie les noeuds du chemin qu'il modifie, les
+ *  rééquilibre, puis publie la nouvelle racine par une écriture atomique. Un
+ *  lecteur voit donc toujours une version complète et cohérente de l'arbre.
+ *
+ *  Les noeuds remplacés sont libérés par époques : chaque lecteur annonce
+ *  l'époque globale dans un emplacement libre le temps de sa lecture, et un
+ *  noeud retiré à l'époque e n'est libéré qu'une fois tous les lecteurs
+ *  d'époque <= e partis.
+ *
+ *  @tparam T type des clés, comparées par operator< et operator>
+ *  @tparam ReaderSlots nombre de lecteurs simultanés sans verrou. Les suivants se
+ *          partagent un dernier emplacement, protégé par un mutex
+ */
+template<typename T, size_t ReaderSlots = 128>
+class ConcurrentBinarySearchTree {
+public:
+    using value_type = T;
+    using const_reference = const T &;
+
+private:
+    /**
+     *  @brief Noeud de l'arbre. Immuable une fois publié.
+     */
+    struct Node {
+        const value_type key;
+        Node *right;
+        Node *left;
+        size_t nbElements;  // nombre de noeuds dans le sous arbre dont ce noeud est la racine
+        unsigned height;    // hauteur du sous arbre dont ce noeud est la racine
+        uint64_t version;   // écriture qui a créé le noeud
+
+        Node(const_reference key, uint64_t version)
+                : key(key), right(nullptr), left(nullptr), nbElements(1), height(1), version(version) {}
+    };
+
+    /**
+     *  @brief Emplacement d'un lecteur, complété pour occuper sa propre ligne de cache
+     */
+    struct Slot {
+        std::atomic<uint64_t> epoch; // époque annoncée, 0 si l'emplacement est libre
+        char padding[64 - sizeof(std::atomic<uint64_t>)];
+    };
+
+    // Un AVL de 2^64 noeuds a une hauteur inférieure à 93
+    static const size_t MaxHeight = 128;
+
+    std::atomic<Node *> _root;
+    std::atomic<uint64_t> _epoch;
+    mutable Slot _slots[ReaderSlots + 1];  // le dernier est celui des lecteurs en surnombre
+    mutable std::mutex _overflow;          // protège _slots[ReaderSlots]
+
+    std::mutex _writer;                                // sérialise les écritures
+    uint64_t _version;                                 // écriture en cours
+    std::vector<Node *> _fresh;                        // noeuds créés par l'écriture en cours
+    std::vector<Node *> _pending;                      // noeuds remplacés par l'écriture en cours
+    std::vector<std::pair<uint64_t, Node *>> _retired; // (époque du retrait, noeud) à libérer
+
+public:
+    ConcurrentBinarySearchTree() : _root(nullptr), _epoch(1), _version(0) {
+        for (Slot &s : _slots)
+            s.epoch.store(0, std::memory_order_relaxed);
+        // Une écriture crée ou remplace au plus deux chemins complets et quelques
+        // noeuds de rotation : ces vecteurs n'ont plus jamais à grandir
+        _fresh.reserve(4 * MaxHeight);
+        _pending.reserve(4 * MaxHeight);
+    }
+
+    ConcurrentBinarySearchTree(const ConcurrentBinarySearchTree &) = delete;
+    ConcurrentBinarySearchTree &operator=(const ConcurrentBinarySearchTree &) = delete;
+
+    /**
+     *  @brief Destructeur. Aucun lecteur ni écrivain ne doit plus utiliser l'arbre.
+     *  @remark Complexité : O(n)
+     */
+    ~ConcurrentBinarySearchTree() {
+        deleteSubTree(_root.load());
+        for (auto &retired : _retired)
+            delete retired.second;
+    }
+
+    //
+    // @brief Insertion d'une cle dans l'arbre
+    // @param key la clé à insérer
+    // @return vrai si la cle est inseree. faux si elle etait deja presente.
+    // @remark Complexité : O(log(n))
+    //
+    bool insert(const_reference key) {
+        std::lock_guard<std::mutex> lock(_writer);
+        Node *root = _root.load(std::memory_order_relaxed);
+        if (find(root, key) != nullptr)
+            return false;
+
+        beginWrite();
+        try {
+            Node **path[MaxHeight];
+            size_t depth = 0;
+            Node **link = &root;
+            while (*link != nullptr) {
+                Node *n = own(*link);
+                *link = n;
+                path[depth++] = link;
+                link = key < n->key ? &n->left : &n->right;
+            }
+            *link = create(key);
+
+            while (depth > 0) {
+                Node *&n = *path[--depth];
+                ++n->nbElements;
+                rebalance(n);
+            }
+        } catch (...) {
+            abortWrite();
+            throw;
+        }
+        publish(root);
+        return true;
+    }
+
+    //
+    // @brief Supprime l'element de cle key de l'arbre.
+    // @param key l'element a supprimer
+    // @return vrai si l'element etait present
+    // @remark Complexité : O(log(n))
+    //
+    bool deleteElement(const_reference key) {
+        std::lock_guard<std::mutex> lock(_writer);
+        Node *root = _root.load(std::memory_order_relaxed);
+        if (find(root, key) == nullptr)
+            return false;
+
+        beginWrite();
+        try {
+            Node **path[MaxHeight];
+            size_t depth = 0;
+            Node **link = &root;
+            while (true) {
+                Node *n = *link;
+                if (key < n->key) {
+                    n = own(n);
+                    *link = n;
+                    path[depth++] = link;
+                    link = &n->left;
+                } else if (key > n->key) {
+                    n = own(n);
+                    *link = n;
+                    path[depth++] = link;
+                    link = &n->right;
+                } else {
+                    break;
+                }
+            }
+
+            Node *found = *link;
+            if (found->left == nullptr) {
+                *link = found->right;
+            } else if (found->right == nullptr) {
+                *link = found->left;
+            } else {
+                // Technique de Hibbard : le plus petit noeud du sous arbre droit prend la place
+                Node *right = found->right;
+                Node **minPath[MaxHeight];
+                size_t minDepth = 0;
+                Node **minLink = &right;
+                while ((*minLink)->left != nullptr) {
+                    Node *n = own(*minLink);
+                    *minLink = n;
+                    minPath[minDepth++] = minLink;
+                    minLink = &n->left;
+                }
+                Node *min = own(*minLink);
+                *minLink = min->right;
+                while (minDepth > 0) {
+                    Node *&n = *minPath[--minDepth];
+                    --n->nbElements;
+                    rebalance(n);
+                }
+
+                min->left = found->left;
+                min->right = right;
+                update(min);
+                *link = min;
+                rebalance(*link);
+            }
+            _pending.push_back(found);
+
+            while (depth > 0) {
+                Node *&n = *path[--depth];
+                --n->nbElements;
+                rebalance(n);
+            }
+        } catch (...) {
+            abortWrite();
+            throw;
+        }
+        publish(root);
+        return true;
+    }
+
+    //
+    // @brief Recherche d'une cle, sans verrou.
+    // @param key la cle a rechercher
+    // @return vrai si la cle trouvee, faux sinon.
+    // @remark Complexité : O(log(n))
+    //
+    bool contains(const_reference key) const {
+        ReadGuard guard(*this);
+        return find(_root.load(), key) != nullptr;
+    }
+
+    //
+    // @brief taille de l'arbre, sans verrou.
+    // @remark Complexité : O(1)
+    //
+    size_t size() const {
+        ReadGuard guard(*this);
+        return subtreeSize(_root.load());
+    }
+
+    //
+    // @brief Recherche de la cle minimale, sans verrou.
+    //
+    // @return une copie de la cle minimale : le noeud peut être libéré dès la fin de la lecture
+    // @exception std::logic_error si l'arbre est vide
+    // @remark Complexité : O(log(n))
+    //
+    value_type min() const {
+        ReadGuard guard(*this);
+        const Node *r = _root.load();
+        if (r == nullptr)
+            throw std::logic_error("Impossible to search the min key in an empty tree");
+        while (r->left != nullptr)
+            r = r->left;
+        return r->key;
+    }
+
+    //
+    // @brief cle en position n, sans verrou.
+    //
+    // @return une copie de la cle en position n par ordre croissant des elements
+    // @exception std::logic_error si n >= size()
+    // @remark Complexité : O(log(n))
+    //
+    value_type nth_element(size_t n) const {
+        ReadGuard guard(*this);
+        const Node *r = _root.load();
+        if (n >= subtreeSize(r))
+            throw std::logic_error("Index trop grand");
+
+        while (true) {
+            size_t leftCount = subtreeSize(r->left);
+            if (n == leftCount)
+                return r->key;
+            if (n < leftCount) {
+                r = r->left;
+            } else {
+                n -= leftCount + 1;
+                r = r->right;
+            }
+        }
+    }
+
+    //
+    // @brief position d'une cle dans l'ordre croissant des elements, sans verrou.
+    // @return la position entre 0 et size()-1, size_t(-1) si la cle est absente
+    // @remark Complexité : O(log(n))
+    //
+    size_t rank(const_reference key) const {
+        ReadGuard guard(*this);
+        const Node *r = _root.load();
+        size_t smaller = 0;
+        while (r != nullptr) {
+            if (key < r->key) {
+                r = r->left;
+            } else if (key > r->key) {
+                smaller += subtreeSize(r->left) + 1;
+                r = r->right;
+            } else {
+                return smaller + subtreeSize(r->left);
+            }
+        }
+        return size_t(-1);
+    }
+
+private:
+    /**
+     *  @brief Annonce une lecture pendant toute sa durée de vie
+     */
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const ConcurrentBinarySearchTree &tree) : _tree(tree), _slot(tree.enterRead()) {}
+
+        ~ReadGuard() {
+            _slot->epoch.store(0, std::memory_order_release);
+            if (_slot == &_tree._slots[ReaderSlots])
+                _tree._overflow.unlock();
+        }
+
+        ReadGuard(const ReadGuard &) = delete;
+        ReadGuard &operator=(const ReadGuard &) = delete;
+
+    private:
+        const ConcurrentBinarySearchTree &_tree;
+        Slot *_slot;
+    };
+
+    /**
+     * @brief Réserve un emplacement de lecteur et y annonce l'époque courante
+     *
+     * L'annonce précède la lecture de la racine : un écrivain qui ne voit pas
+     * l'annonce a déjà publié une racine plus récente que les noeuds qu'il libère.
+     * Quand tous les emplacements sans verrou sont pris, le lecteur attend le
+     * mutex du dernier emplacement plutôt que de boucler : il est libéré par la
+     * fin d'une lecture, jamais par un écrivain.
+     *
+     * @return l'emplacement réservé, à libérer par ReadGuard
+     */
+    Slot *enterRead() const {
+        static thread_local size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id());
+        uint64_t epoch = _epoch.load();
+        for (size_t i = 0; i < ReaderSlots; ++i) {
+            size_t index = (hint + i) % ReaderSlots;
+            uint64_t expected = 0;
+            if (_slots[index].epoch.compare_exchange_strong(expected, epoch)) {
+                hint = index;
+                return &_slots[index];
+            }
+        }
+
+        _overflow.lock();
+        _slots[ReaderSlots].epoch.store(_epoch.load());
+        return &_slots[ReaderSlots];
+    }
+
+    static size_t subtreeSize(const Node *r) noexcept {
+        return r != nullptr ? r->nbElements : 0;
+    }
+
+    static unsigned height(const Node *r) noexcept {
+        return r != nullptr ? r->height : 0;
+    }
+
+    static Node *find(Node *r, const_reference key) noexcept {
+        while (r != nullptr) {
+            if (key < r->key)
+                r = r->left;
+            else if (key > r->key)
+                r = r->right;
+            else
+                return r;
+        }
+        return nullptr;
+    }
+
+    void beginWrite() noexcept {
+        ++_version;
+        _fresh.clear();
+        _pending.clear();
+    }
+
+    /**
+     * @brief Annule l'écriture en cours : rien n'a été publié, les copies sont détruites
+     */
+    void abortWrite() noexcept {
+        for (Node *n : _fresh)
+            delete n;
+        _fresh.clear();
+        _pending.clear();
+    }
+
+    Node *create(const_reference key) {
+        Node *n = new Node(key, _version);
+        _fresh.push_back(n);
+        return n;
+    }
+
+    /**
+     * @brief Rend un noeud modifiable par l'écriture en cours
+     * @param n le noeud
+     * @return n s'il a été créé par cette écriture, sinon une copie de n
+     *         (n sera retiré à la publication)
+     */
+    Node *own(Node *n) {
+        if (n->version == _version)
+            return n;
+        Node *copy = create(n->key);
+        copy->left = n->left;
+        copy->right = n->right;
+        copy->nbElements = n->nbElements;
+        copy->height = n->height;
+        _pending.push_back(n);
+        return copy;
+    }
+
+    /**
+     * @brief Publie une nouvelle racine puis libère ce qui n'est plus lisible
+     *
+     * La place des noeuds à retirer est réservée avant la publication : une fois
+     * la racine publiée, plus rien ne peut échouer. Sinon l'écriture est annulée.
+     *
+     * @exception std::bad_alloc si la réservation échoue, l'arbre est inchangé
+     */
+    void publish(Node *root) {
+        size_t needed = _retired.size() + _pending.size();
+        if (needed > _retired.capacity()) {
+            try {
+                _retired.reserve(std::max(needed, 2 * _retired.capacity()));
+            } catch (...) {
+                abortWrite();
+                throw;
+            }
+        }
+
+        _root.store(root);
+        // Les lecteurs qui annonceront une époque plus grande ne verront que la nouvelle racine
+        uint64_t epoch = _epoch.fetch_add(1);
+        for (Node *n : _pending)
+            _retired.push_back(std::make_pair(epoch, n));
+        _pending.clear();
+        _fresh.clear();
+        reclaim();
+    }
+
+    /**
+     * @brief Libère les noeuds retirés avant l'époque du plus ancien lecteur actif
+     */
+    void reclaim() noexcept {
+        uint64_t oldest = std::numeric_limits<uint64_t>::max();
+        for (const Slot &s : _slots) {
+            uint64_t epoch = s.epoch.load();
+            if (epoch != 0 and epoch < oldest)
+                oldest = epoch;
+        }
+
+        auto stillVisible = std::partition(_retired.begin(), _retired.end(),
+                                           [oldest](const std::pair<uint64_t, Node *> &retired) {
+                                               return retired.first >= oldest;
+                                           });
+        for (auto it = stillVisible; it != _retired.end(); ++it)
+            delete it->second;
+        _retired.erase(stillVisible, _retired.end());
+    }
+
+    static void update(Node *r) noexcept {
+        r->nbElements = 1 + subtreeSize(r->left) + subtreeSize(r->right);
+        r->height = 1 + std::max(height(r->left), height(r->right));
+    }
+
+    // Les rotations ne modifient que des noeuds appartenant à l'écriture en cours
+    void rotateLeft(Node *&r) {
+        Node *x = own(r->right);
+        r->right = x->left;
+        x->left = r;
+        update(r);
+        update(x);
+        r = x;
+    }
+
+    void rotateRight(Node *&r) {
+        Node *x = own(r->left);
+        r->left = x->right;
+        x->right = r;
+        update(r);
+        update(x);
+        r = x;
+    }
+
+    /**
+     * @brief Rééquilibrage AVL d'un noeud de l'écriture en cours dont les sous arbres sont équilibrés
+     */
+    void rebalance(Node *&r) {
+        update(r);
+        int diff = int(height(r->left)) - int(height(r->right));
+        if (diff > 1) {
+            if (height(r->left->left) < height(r->left->right)) {
+                r->left = own(r->left);
+                rotateLeft(r->left);
+            }
+            rotateRight(r);
+        } else if (diff < -1) {
+            if (height(r->right->right) < height(r->right->left)) {
+                r->right = own(r->right);
+                rotateRight(r->right);
+            }
+            rotateLeft(r);
+        }
+    }
+
+    static void deleteSubTree(Node *r) noexcept {
+        while (r != nullptr) {
+            if (r->left != nullptr) {
+                Node *l = r->left;
+                r->left = l->right;
+                l->right = r;
+                r = l;
+            } else {
+                Node *next = r->right;
+                delete r;
+                r = next;
+            }
+        }
+    }
+};
+
+#endif // CONCURRENT_BINARY_SEARCH_TREE_H
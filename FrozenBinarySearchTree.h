@@ -0,0 +1,382 @@
+/**
+-----------------------------------------------------------------------------------
+Laboratoire : 09
+\file       FrozenBinarySearchTree.h
+\author     Loïc Dessaules, Doran Kayoumi, Gabrielle Thurnherr
+\date       16/10/2026
+\brief      Forme figée d'un arbre binaire de recherche : les clés sont rangées
+            dans des tableaux contigus, sans pointeur
+Compilateur MinGW-gcc 6.3.0
+
+Copyright (c) 2017 Olivier Cuisenaire. All rights reserved.
+**/
+
+#ifndef FROZEN_BINARY_SEARCH_TREE_H
+#define FROZEN_BINARY_SEARCH_TREE_H
+
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+#include <iterator>
+#include <stdexcept>
+#include <algorithm>
+#include <functional>
+
+template<typename T, typename Compare>
+class SnapshotBinarySearchTree;
+
+/**
+ *  @brief Vue en lecture seule sur la forme figée d'un arbre binaire de recherche,
+ *         sans pointeur entre les clés.
+ *
+ *  Les clés sont rangées deux fois :
+ *  - dans l'ordre d'Eytzinger (parcours en largeur d'un arbre complet : les
+ *    enfants de l'emplacement i sont 2i et 2i+1), pour les recherches. Les
+ *    premiers niveaux, visités par toutes les recherches, tiennent dans quelques
+ *    lignes de cache, et les descendants sont préchargés plusieurs niveaux à
+ *    l'avance ;
+ *  - dans l'ordre croissant, pour nth_element et les parcours d'intervalles.
+ *
+ *  Pour chaque emplacement d'Eytzinger, le rang de sa clé est aussi mémorisé.
+ *  Une clé peut apparaître plusieurs fois (forme figée d'un multiensemble) :
+ *  rank donne alors sa première occurrence.
+ *  La vue ne possède pas ces tableaux : ils appartiennent à un
+ *  FrozenBinarySearchTree ou à un fichier projeté en mémoire
+ *  (SnapshotBinarySearchTree).
+ *
+ *  @tparam T type des clés
+ *  @tparam Compare ordre strict des clés, operator< par défaut
+ */
+template<typename T, typename Compare = std::less<T>>
+class FrozenView {
+public:
+    using value_type = T;
+    using const_reference = const T &;
+    using const_iterator = const T *;
+    using iterator = const_iterator;
+    using key_compare = Compare;
+
+    /**
+     *  @brief Construit une vue sur les tableaux d'une forme figée
+     *
+     *  @param sorted les n clés dans l'ordre croissant
+     *  @param eytzinger les n clés dans l'ordre d'Eytzinger
+     *  @param rank le rang de la clé de chaque emplacement d'Eytzinger
+     *  @param n nombre de clés
+     *  @param comp le comparateur des clés
+     *  @remark Complexité : O(1), les tableaux ne sont pas copiés
+     */
+    FrozenView(const T *sorted, const T *eytzinger, const uint64_t *rank, size_t n,
+               const Compare &comp = Compare())
+            : _comp(comp), _keys(sorted), _slots(eytzinger), _ranks(rank), _count(n) {}
+
+    //
+    // @brief nombre de cles
+    // @remark Complexité : O(1)
+    //
+    size_t size() const noexcept {
+        return _count;
+    }
+
+    bool empty() const noexcept {
+        return _count == 0;
+    }
+
+    const_iterator begin() const noexcept { return _keys; }
+
+    const_iterator end() const noexcept { return _keys + _count; }
+
+    key_compare key_comp() const {
+        return _comp;
+    }
+
+    //
+    // @brief Recherche d'une cle
+    // @return vrai si la cle est présente
+    // @remark Complexité : O(log(n))
+    //
+    bool contains(const_reference key) const noexcept {
+        size_t slot = lowerBoundSlot(key);
+        return slot != 0 and !_comp(key, _slots[slot - 1]);
+    }
+
+    //
+    // @brief position d'une cle dans l'ordre croissant
+    // @return la position entre 0 et size()-1 de sa première occurrence,
+    //         size_t(-1) si la cle est absente
+    // @remark Complexité : O(log(n))
+    //
+    size_t rank(const_reference key) const noexcept {
+        size_t slot = lowerBoundSlot(key);
+        if (slot == 0 or _comp(key, _slots[slot - 1]))
+            return size_t(-1);
+        return size_t(_ranks[slot - 1]);
+    }
+
+    //
+    // @brief nombre de cles strictement plus petites que key
+    // @remark Complexité : O(log(n))
+    //
+    size_t countLess(const_reference key) const noexcept {
+        size_t slot = lowerBoundSlot(key);
+        return slot == 0 ? size() : size_t(_ranks[slot - 1]);
+    }
+
+    //
+    // @brief cle en position n
+    // @exception std::logic_error si n >= size()
+    // @remark Complexité : O(1)
+    //
+    const_reference nth_element(size_t n) const {
+        if (n >= size())
+            throw std::logic_error("Index trop grand");
+        return _keys[n];
+    }
+
+    //
+    // @brief Recherche de la cle minimale
+    // @exception std::logic_error si l'arbre est vide
+    // @remark Complexité : O(1)
+    //
+    const_reference min() const {
+        if (empty())
+            throw std::logic_error("Impossible to search the min key in an empty tree");
+        return _keys[0];
+    }
+
+    //
+    // @brief Première cle qui n'est pas plus petite que key
+    // @remark Complexité : O(log(n))
+    //
+    const_iterator lower_bound(const_reference key) const noexcept {
+        return begin() + countLess(key);
+    }
+
+    //
+    // @brief Première cle strictement plus grande que key
+    // @remark Complexité : O(log(n))
+    //
+    const_iterator upper_bound(const_reference key) const noexcept {
+        size_t slot = upperBoundSlot(key);
+        return begin() + (slot == 0 ? size() : size_t(_ranks[slot - 1]));
+    }
+
+    //
+    // @brief Nombre de cles dans l'intervalle [lo, hi)
+    // @remark Complexité : O(log(n))
+    //
+    size_t countRange(const_reference lo, const_reference hi) const noexcept {
+        if (!_comp(lo, hi))
+            return 0;
+        return countLess(hi) - countLess(lo);
+    }
+
+    //
+    // @brief Parcours des cles de l'intervalle [lo, hi), dans l'ordre croissant
+    // @remark Complexité : O(log(n) + k), les k cles visitées sont contiguës
+    //
+    template<typename Fn>
+    void forEachInRange(const_reference lo, const_reference hi, Fn &&f) const {
+        for (const_iterator it = lower_bound(lo); it != end() and _comp(*it, hi); ++it)
+            f(*it);
+    }
+
+protected:
+    /**
+     * @brief Fait pointer la vue sur d'autres tableaux, par exemple après une copie
+     */
+    void attach(const T *sorted, const T *eytzinger, const uint64_t *rank, size_t n) noexcept {
+        _keys = sorted;
+        _slots = eytzinger;
+        _ranks = rank;
+        _count = n;
+    }
+
+private:
+    /**
+     * @brief Emplacement d'Eytzinger (à partir de 1) de la première clé >= key
+     * @return l'emplacement, 0 si toutes les clés sont plus petites
+     * @remark Complexité : O(log(n))
+     */
+    size_t lowerBoundSlot(const_reference key) const noexcept {
+        return boundSlot([&](const_reference k) { return _comp(k, key); });
+    }
+
+    /**
+     * @brief Emplacement d'Eytzinger (à partir de 1) de la première clé > key
+     * @return l'emplacement, 0 si aucune clé n'est plus grande
+     * @remark Complexité : O(log(n))
+     */
+    size_t upperBoundSlot(const_reference key) const noexcept {
+        return boundSlot([&](const_reference k) { return !_comp(key, k); });
+    }
+
+    /**
+     * @brief Emplacement d'Eytzinger de la première clé k telle que goRight(k) est faux
+     *
+     * Descente sans branchement : on part à droite si goRight(clé de l'emplacement).
+     * A la sortie, les bits de poids faible de i à 1 sont les derniers
+     * déplacements à droite : on les retire, plus un, pour retrouver le dernier
+     * emplacement où l'on est parti à gauche.
+     *
+     * @param goRight vrai pour un préfixe des clés dans l'ordre croissant
+     * @return l'emplacement, 0 si goRight est vrai pour toutes les clés
+     * @remark Complexité : O(log(n))
+     */
+    template<typename GoRight>
+    size_t boundSlot(GoRight goRight) const noexcept {
+        const size_t n = _count;
+        const T *keys = _slots;
+        size_t i = 1;
+        while (i <= n) {
+            prefetch(keys + std::min(i * PrefetchStride, n) - 1);
+            i = 2 * i + bool(goRight(keys[i - 1]));
+        }
+        return i >> (trailingOnes(i) + 1);
+    }
+
+    // Nombre d'emplacements d'une ligne de cache : les descendants d'un emplacement
+    // situés PrefetchStride fois plus loin tiennent dans une même ligne
+    static const size_t PrefetchStride = sizeof(T) < 64 ? 64 / sizeof(T) : 1;
+
+    static void prefetch(const T *p) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(p);
+#else
+        (void) p;
+#endif
+    }
+
+    static unsigned trailingOnes(size_t i) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        return ~i == 0 ? sizeof(size_t) * 8 : unsigned(__builtin_ctzll((unsigned long long) ~i));
+#else
+        unsigned cnt = 0;
+        while (i & 1) {
+            i >>= 1;
+            ++cnt;
+        }
+        return cnt;
+#endif
+    }
+
+    // écrit les trois tableaux dans un fichier
+    friend class SnapshotBinarySearchTree<T, Compare>;
+
+    Compare _comp;
+    const T *_keys;            // clés par ordre croissant
+    const T *_slots;           // clés dans l'ordre d'Eytzinger, l'emplacement i est à l'indice i-1
+    const uint64_t *_ranks;    // rang de la clé de chaque emplacement d'Eytzinger
+    size_t _count;
+};
+
+/**
+ *  @brief Arbre binaire de recherche immuable, stocké sans pointeur.
+ *
+ *  Possède les tableaux décrits dans FrozenView, qui fournit les recherches.
+ *  On l'obtient normalement par BinarySearchTree::freeze().
+ *
+ *  @tparam T type des clés
+ *  @tparam Compare ordre strict des clés, operator< par défaut
+ */
+template<typename T, typename Compare = std::less<T>>
+class FrozenBinarySearchTree : public FrozenView<T, Compare> {
+    using View = FrozenView<T, Compare>;
+
+public:
+    /**
+     *  @brief Construit une forme figée vide
+     */
+    FrozenBinarySearchTree() : View(nullptr, nullptr, nullptr, 0) {}
+
+    /**
+     *  @brief Construit la forme figée d'une séquence de clés
+     *
+     *  @param first début de la séquence, qui doit être croissante selon comp ; une
+     *               clé répétée (multiensemble) occupe un emplacement par occurrence
+     *  @param last fin de la séquence
+     *  @param comp le comparateur des clés
+     *  @remark Complexité : O(n)
+     */
+    template<typename InputIt>
+    FrozenBinarySearchTree(InputIt first, InputIt last, const Compare &comp = Compare())
+            : View(nullptr, nullptr, nullptr, 0, comp), _sorted(first, last) {
+        buildLayout();
+        reattach();
+    }
+
+    FrozenBinarySearchTree(const FrozenBinarySearchTree &other)
+            : View(other), _sorted(other._sorted), _eytzinger(other._eytzinger), _rank(other._rank) {
+        reattach();
+    }
+
+    FrozenBinarySearchTree(FrozenBinarySearchTree &&other) noexcept
+            : View(other), _sorted(std::move(other._sorted)), _eytzinger(std::move(other._eytzinger)),
+              _rank(std::move(other._rank)) {
+        reattach();
+        other.reattach();
+    }
+
+    FrozenBinarySearchTree &operator=(FrozenBinarySearchTree other) {
+        View::operator=(other);
+        _sorted.swap(other._sorted);
+        _eytzinger.swap(other._eytzinger);
+        _rank.swap(other._rank);
+        reattach();
+        return *this;
+    }
+
+private:
+    /**
+     * @brief Fait pointer la vue sur les tableaux possédés
+     */
+    void reattach() noexcept {
+        this->attach(_sorted.data(), _eytzinger.data(), _rank.data(), _sorted.size());
+    }
+
+    /**
+     * @brief Remplit l'ordre d'Eytzinger à partir des clés triées
+     *
+     * Parcours symétrique de l'arbre implicite : la k-ème clé va dans le k-ème
+     * emplacement visité.
+     *
+     * @remark Complexité : O(n)
+     */
+    void buildLayout() {
+        const size_t n = _sorted.size();
+        std::vector<size_t> slotOfRank(n);
+
+        size_t i = 1;
+        while (2 * i <= n)
+            i *= 2;
+        for (size_t k = 0; k < n; ++k) {
+            slotOfRank[k] = i;
+            // Successeur : le plus à gauche du sous arbre droit, sinon on remonte
+            // tant qu'on est un enfant droit, puis une fois de plus
+            if (2 * i + 1 <= n) {
+                i = 2 * i + 1;
+                while (2 * i <= n)
+                    i *= 2;
+            } else {
+                while (i & 1)
+                    i >>= 1;
+                i >>= 1;
+            }
+        }
+
+        _rank.assign(n, 0);
+        for (size_t k = 0; k < n; ++k)
+            _rank[slotOfRank[k] - 1] = k;
+
+        _eytzinger.clear();
+        _eytzinger.reserve(n);
+        for (size_t slot = 0; slot < n; ++slot)
+            _eytzinger.push_back(_sorted[_rank[slot]]);
+    }
+
+    std::vector<T> _sorted;       // clés par ordre croissant
+    std::vector<T> _eytzinger;    // clés dans l'ordre d'Eytzinger
+    std::vector<uint64_t> _rank;  // rang de la clé de chaque emplacement d'Eytzinger
+};
+
+#endif // FROZEN_BINARY_SEARCH_TREE_H
@@ -0,0 +1,293 @@
+/**
+-----------------------------------------------------------------------------------
+Laboratoire : 09
+\file       SnapshotBinarySearchTree.h
+\author     Loïc Dessaules, Doran Kayoumi, Gabrielle Thurnherr
+\date       16/10/2026
+\brief      Image d'un arbre binaire de recherche dans un fichier, projetée en
+            mémoire et interrogée sans désérialisation
+Compilateur MinGW-gcc 6.3.0
+
+Copyright (c) 2017 Olivier Cuisenaire. All rights reserved.
+**/
+
+#ifndef SNAPSHOT_BINARY_SEARCH_TREE_H
+#define SNAPSHOT_BINARY_SEARCH_TREE_H
+
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <functional>
+
+#include "FrozenBinarySearchTree.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define SNAPSHOT_USE_MMAP 1
+#endif
+
+/**
+ *  @brief En-tête d'une image. Les positions sont comptées depuis le début du
+ *         fichier : l'image ne dépend pas de l'adresse où elle est projetée.
+ *
+ *  L'en-tête est suivi, chacun aligné sur SnapshotAlign octets, des clés dans
+ *  l'ordre croissant, des clés dans l'ordre d'Eytzinger et du rang (uint64_t)
+ *  de la clé de chaque emplacement d'Eytzinger.
+ */
+struct SnapshotHeader {
+    char magic[8];            // "BSTSNAP"
+    uint32_t version;
+    uint32_t byteOrder;       // SnapshotByteOrder, tel que rangé par la machine qui a écrit
+    uint32_t keySize;         // sizeof(T)
+    uint32_t keyAlign;        // alignof(T)
+    uint64_t count;           // nombre de clés
+    uint64_t sortedOffset;
+    uint64_t eytzingerOffset;
+    uint64_t rankOffset;
+    uint64_t fileSize;
+};
+
+static const char SnapshotMagic[8] = "BSTSNAP";
+static const uint32_t SnapshotVersion = 1;
+static const uint32_t SnapshotByteOrder = 0x01020304;
+static const uint64_t SnapshotAlign = 64; // une ligne de cache
+
+/**
+ *  @brief Forme figée d'un arbre, lue directement dans une image projetée en mémoire.
+ *
+ *  Le constructeur ne lit que l'en-tête et les rangs, qui doivent tous désigner
+ *  une clé : contains, rank, nth_element et les parcours d'intervalles
+ *  travaillent sur les pages des clés, chargées à la demande par le système.
+ *  Sans mmap (hors POSIX), le fichier est lu en une fois dans un tampon.
+ *
+ *  L'image n'est valable que sur une machine de même boutisme et pour le même T,
+ *  ce qui est vérifié à l'ouverture.
+ *
+ *  @tparam T type des clés, trivialement copiable
+ *  @tparam Compare ordre strict des clés, le même que celui de l'arbre sauvé
+ */
+template<typename T, typename Compare = std::less<T>>
+class SnapshotBinarySearchTree : public FrozenView<T, Compare> {
+    static_assert(std::is_trivially_copyable<T>::value, "Seules les cles trivialement copiables ont une image");
+    static_assert(alignof(T) <= SnapshotAlign, "Alignement des cles trop grand");
+
+    using View = FrozenView<T, Compare>;
+
+public:
+    /**
+     *  @brief Ouvre une image écrite par save
+     *
+     *  @param path chemin du fichier
+     *  @param comp le comparateur des clés
+     *  @exception std::runtime_error si le fichier ne peut être lu, ou n'est pas
+     *             une image de clés T écrite sur une machine compatible, ou si
+     *             un rang dépasse le nombre de clés
+     *  @remark Complexité : O(n) pour vérifier les rangs, O(taille du fichier) sans mmap
+     */
+    explicit SnapshotBinarySearchTree(const std::string &path, const Compare &comp = Compare())
+            : View(nullptr, nullptr, nullptr, 0, comp), _base(nullptr), _length(0), _buffer(nullptr) {
+        map(path);
+        try {
+            const char *base = static_cast<const char *>(_base);
+            SnapshotHeader header = checkHeader(path, base, _length);
+            const uint64_t *ranks = reinterpret_cast<const uint64_t *>(base + header.rankOffset);
+            checkRanks(path, ranks, header.count);
+            this->attach(reinterpret_cast<const T *>(base + header.sortedOffset),
+                         reinterpret_cast<const T *>(base + header.eytzingerOffset), ranks, size_t(header.count));
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    SnapshotBinarySearchTree(const SnapshotBinarySearchTree &) = delete;
+
+    SnapshotBinarySearchTree &operator=(const SnapshotBinarySearchTree &) = delete;
+
+    SnapshotBinarySearchTree(SnapshotBinarySearchTree &&other) noexcept
+            : View(other), _base(other._base), _length(other._length), _buffer(other._buffer) {
+        other.forget();
+    }
+
+    SnapshotBinarySearchTree &operator=(SnapshotBinarySearchTree &&other) noexcept {
+        if (this != &other) {
+            release();
+            View::operator=(other);
+            _base = other._base;
+            _length = other._length;
+            _buffer = other._buffer;
+            other.forget();
+        }
+        return *this;
+    }
+
+    ~SnapshotBinarySearchTree() {
+        release();
+    }
+
+    /**
+     *  @brief Ecrit l'image d'une forme figée
+     *
+     *  @param path chemin du fichier, remplacé s'il existe
+     *  @param view la forme figée, par exemple un FrozenBinarySearchTree
+     *  @exception std::runtime_error si le fichier ne peut être écrit
+     *  @remark Complexité : O(n)
+     */
+    static void save(const std::string &path, const View &view) {
+        const uint64_t n = view.size();
+        SnapshotHeader header;
+        std::memset(&header, 0, sizeof header);
+        std::memcpy(header.magic, SnapshotMagic, sizeof header.magic);
+        header.version = SnapshotVersion;
+        header.byteOrder = SnapshotByteOrder;
+        header.keySize = sizeof(T);
+        header.keyAlign = alignof(T);
+        header.count = n;
+        header.sortedOffset = alignUp(sizeof header);
+        header.eytzingerOffset = alignUp(header.sortedOffset + n * sizeof(T));
+        header.rankOffset = alignUp(header.eytzingerOffset + n * sizeof(T));
+        header.fileSize = header.rankOffset + n * sizeof(uint64_t);
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        uint64_t written = 0;
+        write(out, &header, sizeof header, written);
+        pad(out, header.sortedOffset, written);
+        write(out, view._keys, n * sizeof(T), written);
+        pad(out, header.eytzingerOffset, written);
+        write(out, view._slots, n * sizeof(T), written);
+        pad(out, header.rankOffset, written);
+        write(out, view._ranks, n * sizeof(uint64_t), written);
+        out.close();
+        if (!out)
+            throw std::runtime_error("Impossible d'ecrire l'image " + path);
+    }
+
+private:
+    static uint64_t alignUp(uint64_t offset) noexcept {
+        return (offset + SnapshotAlign - 1) / SnapshotAlign * SnapshotAlign;
+    }
+
+    static void write(std::ofstream &out, const void *data, uint64_t bytes, uint64_t &written) {
+        if (bytes != 0)
+            out.write(static_cast<const char *>(data), std::streamsize(bytes));
+        written += bytes;
+    }
+
+    static void pad(std::ofstream &out, uint64_t offset, uint64_t &written) {
+        static const char zeros[SnapshotAlign] = {};
+        write(out, zeros, offset - written, written);
+    }
+
+    /**
+     * @brief Vérifie que l'en-tête décrit une image de clés T cohérente avec la taille du fichier
+     * @remark Complexité : O(1), les clés ne sont pas relues
+     */
+    static SnapshotHeader checkHeader(const std::string &path, const char *base, size_t length) {
+        SnapshotHeader header;
+        if (length < sizeof header)
+            throw std::runtime_error("Image tronquee : " + path);
+        std::memcpy(&header, base, sizeof header);
+        if (std::memcmp(header.magic, SnapshotMagic, sizeof header.magic) != 0 or header.version != SnapshotVersion)
+            throw std::runtime_error("Format d'image inconnu : " + path);
+        if (header.byteOrder != SnapshotByteOrder or header.keySize != sizeof(T) or header.keyAlign != alignof(T))
+            throw std::runtime_error("Image ecrite pour une autre machine ou un autre type de cle : " + path);
+
+        // Chaque tableau est comparé à length avant toute addition : les sommes
+        // suivantes ne dépassent donc pas length, un en-tête forgé ne peut pas
+        // les faire déborder pour passer la vérification
+        bool consistent = header.fileSize == length
+                          and header.sortedOffset % SnapshotAlign == 0 and header.sortedOffset >= sizeof header
+                          and header.eytzingerOffset % SnapshotAlign == 0
+                          and header.rankOffset % SnapshotAlign == 0
+                          and fits(header.sortedOffset, header.count, sizeof(T), length)
+                          and fits(header.eytzingerOffset, header.count, sizeof(T), length)
+                          and fits(header.rankOffset, header.count, sizeof(uint64_t), length)
+                          and header.eytzingerOffset >= header.sortedOffset + header.count * sizeof(T)
+                          and header.rankOffset >= header.eytzingerOffset + header.count * sizeof(T);
+        if (!consistent)
+            throw std::runtime_error("Image corrompue : " + path);
+        return header;
+    }
+
+    /**
+     * @brief Vérifie que chaque rang désigne une clé : rank, countLess et les
+     *        bornes s'en servent comme indice dans les clés triées, sans contrôle
+     * @remark Complexité : O(n)
+     */
+    static void checkRanks(const std::string &path, const uint64_t *ranks, uint64_t count) {
+        for (uint64_t i = 0; i < count; ++i)
+            if (ranks[i] >= count)
+                throw std::runtime_error("Image corrompue, rang hors limites : " + path);
+    }
+
+    // vrai si count éléments de size octets, à partir de offset, tiennent dans length octets
+    static bool fits(uint64_t offset, uint64_t count, uint64_t size, uint64_t length) noexcept {
+        return offset <= length and count <= (length - offset) / size;
+    }
+
+    /**
+     * @brief Projette le fichier en mémoire (ou le lit, sans mmap) dans _base
+     */
+    void map(const std::string &path) {
+#ifdef SNAPSHOT_USE_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Impossible d'ouvrir l'image " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0 or st.st_size <= 0) {
+            ::close(fd);
+            throw std::runtime_error("Image vide ou illisible : " + path);
+        }
+        _length = size_t(st.st_size);
+        void *p = ::mmap(nullptr, _length, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED)
+            throw std::runtime_error("Impossible de projeter l'image " + path);
+        _base = p;
+#else
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in)
+            throw std::runtime_error("Impossible d'ouvrir l'image " + path);
+        _length = size_t(in.tellg());
+        // tampon aligné sur SnapshotAlign, comme le serait une projection
+        _buffer = new char[_length + SnapshotAlign];
+        char *aligned = _buffer + (SnapshotAlign - uintptr_t(_buffer) % SnapshotAlign) % SnapshotAlign;
+        in.seekg(0);
+        if (!in.read(aligned, std::streamsize(_length))) {
+            delete[] _buffer;
+            _buffer = nullptr;
+            throw std::runtime_error("Impossible de lire l'image " + path);
+        }
+        _base = aligned;
+#endif
+    }
+
+    void release() noexcept {
+#ifdef SNAPSHOT_USE_MMAP
+        if (_base != nullptr)
+            ::munmap(_base, _length);
+#endif
+        delete[] _buffer;
+        forget();
+    }
+
+    void forget() noexcept {
+        this->attach(nullptr, nullptr, nullptr, 0);
+        _base = nullptr;
+        _length = 0;
+        _buffer = nullptr;
+    }
+
+    void *_base;      // début de l'image
+    size_t _length;   // taille de l'image en octets
+    char *_buffer;    // tampon alloué quand l'image est lue plutôt que projetée
+};
+
+#endif // SNAPSHOT_BINARY_SEARCH_TREE_H
@@ -0,0 +1,1165 @@
+/**
+-----------------------------------------------------------------------------------
+Laboratoire : 09
+\file       bst_bench.cpp
+\author     Loïc Dessaules, Doran Kayoumi, Gabrielle Thurnherr
+\date       16/10/2026
+\brief      Mesures de performance des arbres binaires de recherche, écrites en
+            JSON (format proche de celui de Google Benchmark)
+Compilateur MinGW-gcc 6.3.0
+
+Utilisation : bst_bench [--sizes=1000,10000,...] [--max-size=N] [--filter=texte]
+                        [--min-time=secondes] [--max-degenerate=N] [--threads=N]
+                        [--out=fichier.json]
+
+Pour des mesures significatives, configurer avec -DCMAKE_BUILD_TYPE=Release.
+
+Copyright (c) 2017 Olivier Cuisenaire. All rights reserved.
+**/
+
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+
+#include "BinarySearchTree.h"
+#include "ConcurrentBinarySearchTree.h"
+#include "BTree.h"
+
+// Nombre d'allocations dynamiques du programme, tous threads confondus
+static std::atomic<size_t> allocations(0);
+
+void *operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size != 0 ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+using Key = int;
+using Clock = std::chrono::steady_clock;
+
+// Les résultats des opérations mesurées y sont accumulés pour que le compilateur ne les supprime pas
+volatile size_t sink;
+
+struct Options {
+    std::vector<size_t> sizes{1000, 10000, 100000, 1000000, 10000000};
+    std::string filter;
+    std::string out;
+    double minTime = 0.5;          // durée mesurée minimale de chaque benchmark, en secondes
+    size_t maxDegenerate = 20000;  // taille maximale d'un arbre non équilibré construit à partir de clés triées
+    size_t maxQueries = 1 << 20;   // nombre maximal de recherches d'une passe
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+};
+
+/**
+ *  @brief Chronomètre d'un benchmark : seules les portions entre start et stop
+ *         sont mesurées, avec les allocations qu'elles font.
+ */
+class State {
+public:
+    void start() {
+        _allocStart = allocations.load(std::memory_order_relaxed);
+        _t0 = Clock::now();
+    }
+
+    void stop() {
+        _elapsed += std::chrono::duration<double>(Clock::now() - _t0).count();
+        _allocs += allocations.load(std::memory_order_relaxed) - _allocStart;
+    }
+
+    double elapsed() const { return _elapsed; }
+
+    size_t allocs() const { return _allocs; }
+
+private:
+    Clock::time_point _t0;
+    double _elapsed = 0;
+    size_t _allocStart = 0;
+    size_t _allocs = 0;
+};
+
+struct Result {
+    std::string name;
+    size_t iterations;   // nombre de passes
+    double nsPerOp;
+    double allocsPerOp;
+    size_t height;       // hauteur de l'arbre après la passe, 0 si sans objet
+};
+
+/**
+ *  @brief Exécute les benchmarks sélectionnés et garde leurs résultats
+ */
+class Runner {
+public:
+    explicit Runner(const Options &options) : _options(options) {}
+
+    bool selected(const std::string &name) const {
+        return _options.filter.empty() or name.find(_options.filter) != std::string::npos;
+    }
+
+    /**
+     * @brief Répète pass jusqu'à avoir mesuré au moins minTime secondes
+     * @param name nom du benchmark, de la forme operation/variante/.../taille
+     * @param ops nombre d'opérations d'une passe
+     * @param pass appelée avec le State, fait une passe et retourne la hauteur de l'arbre
+     */
+    template<typename Pass>
+    void run(const std::string &name, size_t ops, Pass pass) {
+        if (!selected(name) or ops == 0)
+            return;
+        State state;
+        size_t passes = 0, height = 0;
+        do {
+            height = pass(state);
+            ++passes;
+        } while (state.elapsed() < _options.minTime and passes < 1000000);
+
+        double total = double(passes) * double(ops);
+        Result r{name, passes, state.elapsed() * 1e9 / total, double(state.allocs()) / total, height};
+        _results.push_back(r);
+        std::fprintf(stderr, "%-55s %12.1f ns/op %10.3f allocs/op %8zu height %8zu passes\n",
+                     r.name.c_str(), r.nsPerOp, r.allocsPerOp, r.height, r.iterations);
+    }
+
+    const Options &options() const { return _options; }
+
+    void write(std::ostream &os) const {
+        std::time_t now = std::time(nullptr);
+        char date[32];
+        std::strftime(date, sizeof date, "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+        os << "{\n  \"context\": {\n"
+           << "    \"date\": \"" << date << "\",\n"
+           << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+           << "    \"library_build_type\": \"" << buildType() << "\"\n"
+           << "  },\n  \"benchmarks\": [";
+        for (size_t i = 0; i < _results.size(); ++i) {
+            const Result &r = _results[i];
+            os << (i == 0 ? "\n" : ",\n")
+               << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+               << ", \"real_time\": " << r.nsPerOp << ", \"time_unit\": \"ns\""
+               << ", \"allocations_per_op\": " << r.allocsPerOp
+               << ", \"max_height\": " << r.height << "}";
+        }
+        os << "\n  ]\n}\n";
+    }
+
+    static const char *buildType() {
+#if defined(__OPTIMIZE__) || (defined(_MSC_VER) && defined(NDEBUG))
+        return "release";
+#else
+        return "debug";
+#endif
+    }
+
+private:
+    Options _options;
+    std::vector<Result> _results;
+};
+
+/**
+ *  @brief Loi de Zipf sur [0, n) (Gray et al., "Quickly generating billion-record
+ *         synthetic databases") : le rang 0 est le plus fréquent.
+ */
+class Zipf {
+public:
+    Zipf(size_t n, double theta) : _n(n), _theta(theta) {
+        _zetan = zeta(n);
+        double zeta2 = zeta(2);
+        _alpha = 1 / (1 - theta);
+        _eta = (1 - std::pow(2.0 / double(n), 1 - theta)) / (1 - zeta2 / _zetan);
+    }
+
+    template<typename Rng>
+    size_t operator()(Rng &rng) const {
+        double u = std::uniform_real_distribution<double>(0, 1)(rng);
+        double uz = u * _zetan;
+        if (uz < 1)
+            return 0;
+        if (uz < 1 + std::pow(0.5, _theta))
+            return 1;
+        return std::min(_n - 1, size_t(double(_n) * std::pow(_eta * u - _eta + 1, _alpha)));
+    }
+
+private:
+    double zeta(size_t n) const {
+        double sum = 0;
+        for (size_t i = 1; i <= n; ++i)
+            sum += 1 / std::pow(double(i), _theta);
+        return sum;
+    }
+
+    size_t _n;
+    double _theta, _zetan, _alpha, _eta;
+};
+
+/**
+ *  @brief Clés d'un benchmark. Toutes sont paires : k + 1 n'est jamais présente.
+ */
+struct Dataset {
+    std::string distribution;
+    std::vector<Key> keys;     // dans l'ordre d'insertion
+    std::vector<Key> probes;   // clés présentes, dans un ordre aléatoire
+    bool degenerate;           // vrai si un arbre non équilibré construit à partir de keys est une liste
+};
+
+Dataset makeDataset(const std::string &distribution, size_t n, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    Dataset d{distribution, std::vector<Key>(n), {}, distribution == "sorted" or distribution == "reverse"};
+    for (size_t i = 0; i < n; ++i)
+        d.keys[i] = Key(2 * i);
+    if (distribution == "random") {
+        std::shuffle(d.keys.begin(), d.keys.end(), rng);
+    } else if (distribution == "reverse") {
+        std::reverse(d.keys.begin(), d.keys.end());
+    } else if (distribution == "zipfian") {
+        // Les rangs fréquents sont dispersés dans l'espace des clés
+        Zipf zipf(n, 0.99);
+        for (size_t i = 0; i < n; ++i)
+            d.keys[i] = Key(2 * ((uint64_t(zipf(rng)) * 2654435761u) % n));
+    }
+
+    d.probes = d.keys;
+    std::sort(d.probes.begin(), d.probes.end());
+    d.probes.erase(std::unique(d.probes.begin(), d.probes.end()), d.probes.end());
+    std::shuffle(d.probes.begin(), d.probes.end(), rng);
+    return d;
+}
+
+std::string name(const std::string &op, const std::string &variant, size_t n) {
+    return op + "/" + variant + "/" + std::to_string(n);
+}
+
+// Les cles d'une passe de recherches : au plus maxQueries
+std::vector<Key> queries(const Runner &runner, const Dataset &d) {
+    size_t q = std::min(d.probes.size(), runner.options().maxQueries);
+    return std::vector<Key>(d.probes.begin(), d.probes.begin() + q);
+}
+
+/**
+ *  @brief Opérations de base sur un arbre d'une politique d'équilibrage donnée :
+ *         avec AVLBalance, le coût par opération ne doit pas dépendre de l'ordre
+ *         des clés et ne croître qu'en log(n)
+ */
+template<typename Balance>
+void treeBenchmarks(Runner &runner, const std::string &policy, const Dataset &d) {
+    using Tree = BinarySearchTree<Key, Balance>;
+    const size_t n = d.keys.size();
+    const std::string variant = policy + "/" + d.distribution;
+    const std::vector<Key> probes = queries(runner, d);
+
+    runner.run(name("insert", variant, n), n, [&](State &state) {
+        Tree t;
+        state.start();
+        for (Key k : d.keys)
+            t.insert(k);
+        state.stop();
+        return t.height();
+    });
+
+    Tree base;
+    for (Key k : d.keys)
+        base.insert(k);
+    const size_t height = base.height();
+    const size_t count = base.size();
+
+    runner.run(name("contains", variant, n), probes.size(), [&](State &state) {
+        size_t found = 0;
+        state.start();
+        for (Key k : probes)
+            found += base.contains(k);
+        state.stop();
+        sink = sink + found;
+        return height;
+    });
+
+    runner.run(name("contains_miss", variant, n), probes.size(), [&](State &state) {
+        size_t found = 0;
+        state.start();
+        for (Key k : probes)
+            found += base.contains(k + 1);
+        state.stop();
+        sink = sink + found;
+        return height;
+    });
+
+    // Une seule descente : le coût par requête suit la hauteur, équilibré ou non
+    runner.run(name("rank", variant, n), probes.size(), [&](State &state) {
+        size_t sum = 0;
+        state.start();
+        for (Key k : probes)
+            sum += base.rank(k);
+        state.stop();
+        sink = sink + sum;
+        return height;
+    });
+
+    runner.run(name("rankOrInsertionPoint_miss", variant, n), probes.size(), [&](State &state) {
+        size_t sum = 0;
+        state.start();
+        for (Key k : probes)
+            sum += base.rankOrInsertionPoint(k + 1).first;
+        state.stop();
+        sink = sink + sum;
+        return height;
+    });
+
+    runner.run(name("nth_element", variant, n), probes.size(), [&](State &state) {
+        size_t sum = 0;
+        state.start();
+        for (size_t i = 0; i < probes.size(); ++i)
+            sum += size_t(base.nth_element(size_t(probes[i] / 2) % count));
+        state.stop();
+        sink = sink + sum;
+        return height;
+    });
+
+    runner.run(name("deleteElement", variant, n), count, [&](State &state) {
+        Tree t(base);
+        state.start();
+        for (Key k : d.probes)
+            t.deleteElement(k);
+        state.stop();
+        return height;
+    });
+
+    runner.run(name("deleteMin", variant, n), count, [&](State &state) {
+        Tree t(base);
+        state.start();
+        while (t.size() != 0)
+            t.deleteMin();
+        state.stop();
+        return height;
+    });
+
+    runner.run(name("copy", variant, n), count, [&](State &state) {
+        state.start();
+        Tree t(base);
+        state.stop();
+        sink = sink + t.size();
+        return height;
+    });
+
+    runner.run(name("move", variant, n), 1, [&](State &state) {
+        state.start();
+        Tree t(std::move(base));
+        base.swap(t);
+        state.stop();
+        return height;
+    });
+
+    // Destruction : itérative, quelle que soit la forme de l'arbre
+    runner.run(name("destroy", variant, n), count, [&](State &state) {
+        Tree *t = new Tree(base);
+        state.start();
+        delete t;
+        state.stop();
+        return height;
+    });
+
+    runner.run(name("visitSym", variant, n), count, [&](State &state) {
+        size_t sum = 0;
+        state.start();
+        base.visitSym([&](Key k) { sum += size_t(k); });
+        state.stop();
+        sink = sink + sum;
+        return height;
+    });
+
+    runner.run(name("visitPre", variant, n), count, [&](State &state) {
+        size_t sum = 0;
+        state.start();
+        base.visitPre([&](Key k) { sum += size_t(k); });
+        state.stop();
+        sink = sink + sum;
+        return height;
+    });
+
+    runner.run(name("visitPost", variant, n), count, [&](State &state) {
+        size_t sum = 0;
+        state.start();
+        base.visitPost([&](Key k) { sum += size_t(k); });
+        state.stop();
+        sink = sink + sum;
+        return height;
+    });
+
+    runner.run(name("iterate", variant, n), count, [&](State &state) {
+        size_t sum = 0;
+        state.start();
+        for (Key k : base)
+            sum += size_t(k);
+        state.stop();
+        sink = sink + sum;
+        return height;
+    });
+
+    runner.run(name("balance", variant, n), count, [&](State &state) {
+        Tree t(base);
+        state.start();
+        t.balance();
+        state.stop();
+        return t.height();
+    });
+}
+
+/**
+ *  @brief Versions récursives d'origine des opérations de BinarySearchTree,
+ *         gardées comme référence pour mesurer les versions itératives.
+ *
+ *  Sans équilibrage, comme BinarySearchTree<Key> : les deux construisent le même
+ *  arbre à partir des mêmes clés. La profondeur de récursion est la hauteur de
+ *  l'arbre, d'où la limite --max-degenerate sur les clés triées.
+ */
+class RecursiveTree {
+    struct Node {
+        const Key key;
+        Node *right = nullptr;
+        Node *left = nullptr;
+        size_t nbElements = 1;
+
+        explicit Node(Key key) : key(key) {}
+    };
+
+    Node *_root = nullptr;
+
+public:
+    RecursiveTree() = default;
+
+    RecursiveTree(const RecursiveTree &other) {
+        copy(other._root);
+    }
+
+    RecursiveTree &operator=(const RecursiveTree &) = delete;
+
+    ~RecursiveTree() {
+        if (_root != nullptr)
+            deleteSubTree(_root);
+    }
+
+    void insert(Key key) {
+        insert(_root, key);
+    }
+
+    bool contains(Key key) const {
+        return contains(_root, key);
+    }
+
+    Key nth_element(size_t n) const {
+        return nth_element(_root, n);
+    }
+
+    size_t rank(Key key) const {
+        return rank(_root, key);
+    }
+
+    template<typename Fn>
+    void visitSym(Fn f) const {
+        visitSym(f, _root);
+    }
+
+    size_t size() const {
+        return _root != nullptr ? _root->nbElements : 0;
+    }
+
+    size_t height() const {
+        return height(_root);
+    }
+
+private:
+    void copy(const Node *n) {
+        if (n != nullptr) {
+            insert(n->key);
+            copy(n->left);
+            copy(n->right);
+        }
+    }
+
+    static void deleteSubTree(Node *r) {
+        if (r->left != nullptr)
+            deleteSubTree(r->left);
+        if (r->right != nullptr)
+            deleteSubTree(r->right);
+        delete r;
+    }
+
+    static bool insert(Node *&r, Key key) {
+        if (r == nullptr) {
+            r = new Node(key);
+            return true;
+        }
+        if (key < r->key ? insert(r->left, key) : key > r->key and insert(r->right, key)) {
+            ++r->nbElements;
+            return true;
+        }
+        return false;
+    }
+
+    static bool contains(const Node *r, Key key) {
+        if (r == nullptr)
+            return false;
+        if (key < r->key)
+            return contains(r->left, key);
+        if (key > r->key)
+            return contains(r->right, key);
+        return true;
+    }
+
+    static Key nth_element(const Node *r, size_t n) {
+        size_t leftCount = r->left != nullptr ? r->left->nbElements : 0;
+        if (n == leftCount)
+            return r->key;
+        if (n < leftCount)
+            return nth_element(r->left, n);
+        return nth_element(r->right, n - leftCount - 1);
+    }
+
+    // contains à chaque niveau : O(h²)
+    static size_t rank(const Node *r, Key key) {
+        if (r == nullptr or !contains(r, key))
+            return size_t(-1);
+        size_t leftCount = r->left != nullptr ? r->left->nbElements : 0;
+        if (key < r->key)
+            return rank(r->left, key);
+        if (key > r->key)
+            return rank(r->right, key) + leftCount + 1;
+        return leftCount;
+    }
+
+    template<typename Fn>
+    static void visitSym(Fn f, const Node *r) {
+        if (r != nullptr) {
+            visitSym(f, r->left);
+            f(r->key);
+            visitSym(f, r->right);
+        }
+    }
+
+    static size_t height(const Node *r) {
+        return r != nullptr ? 1 + std::max(height(r->left), height(r->right)) : 0;
+    }
+};
+
+/**
+ *  @brief Opérations récursives à l'origine, mesurées sur Tree : BinarySearchTree<Key>
+ *         (itératif) ou RecursiveTree, côte à côte sous les noms .../iterative/...
+ *         et .../recursive/...
+ */
+template<typename Tree>
+void recursionBenchmarks(Runner &runner, const std::string &version, const Dataset &d) {
+    const size_t n = d.keys.size();
+    const std::string variant = version + "/" + d.distribution;
+    const std::vector<Key> probes = queries(runner, d);
+
+    runner.run(name("insert", variant, n), n, [&](State &state) {
+        Tree t;
+        state.start();
+        for (Key k : d.keys)
+            t.insert(k);
+        state.stop();
+        return t.height();
+    });
+
+    Tree base;
+    for (Key k : d.keys)
+        base.insert(k);
+    const size_t height = base.height();
+    const size_t count = base.size();
+
+    runner.run(name("contains", variant, n), probes.size(), [&](State &state) {
+        size_t found = 0;
+        state.start();
+        for (Key k : probes)
+            found += base.contains(k);
+        state.stop();
+        sink = sink + found;
+        return height;
+    });
+
+    runner.run(name("nth_element", variant, n), probes.size(), [&](State &state) {
+        size_t sum = 0;
+        state.start();
+        for (size_t i = 0; i < probes.size(); ++i)
+            sum += size_t(base.nth_element(size_t(probes[i] / 2) % count));
+        state.stop();
+        sink = sink + sum;
+        return height;
+    });
+
+    // Une requête de la version récursive coûte O(h²) : quelques unes suffisent sur une liste
+    const size_t ranks = d.degenerate ? std::min<size_t>(probes.size(), 4) : probes.size();
+    runner.run(name("rank", variant, n), ranks, [&](State &state) {
+        size_t sum = 0;
+        state.start();
+        for (size_t i = 0; i < ranks; ++i)
+            sum += base.rank(probes[i]);
+        state.stop();
+        sink = sink + sum;
+        return height;
+    });
+
+    runner.run(name("visitSym", variant, n), count, [&](State &state) {
+        size_t sum = 0;
+        state.start();
+        base.visitSym([&](Key k) { sum += size_t(k); });
+        state.stop();
+        sink = sink + sum;
+        return height;
+    });
+
+    runner.run(name("copy", variant, n), count, [&](State &state) {
+        state.start();
+        Tree t(base);
+        state.stop();
+        sink = sink + t.size();
+        return height;
+    });
+
+    runner.run(name("destroy", variant, n), count, [&](State &state) {
+        Tree *t = new Tree(base);
+        state.start();
+        delete t;
+        state.stop();
+        return height;
+    });
+}
+
+/**
+ *  @brief Construction en bloc (bulkLoad, copie structurelle) comparée à la
+ *         construction par insertions une par une
+ */
+template<typename Balance>
+void bulkLoadBenchmarks(Runner &runner, const std::string &policy, const Dataset &d) {
+    using Tree = BinarySearchTree<Key, Balance>;
+    const size_t n = d.keys.size();
+    const std::string variant = policy + "/" + d.distribution;
+    std::vector<Key> sorted(d.keys);
+    std::sort(sorted.begin(), sorted.end());
+
+    runner.run(name("load_insert", variant, n), n, [&](State &state) {
+        Tree t;
+        state.start();
+        for (Key k : d.keys)
+            t.insert(k);
+        state.stop();
+        return t.height();
+    });
+
+    // Les clés dans l'ordre de la distribution : triées d'abord si nécessaire
+    runner.run(name("load_bulkLoad", variant, n), n, [&](State &state) {
+        Tree t;
+        state.start();
+        t.bulkLoad(d.keys.begin(), d.keys.end());
+        state.stop();
+        return t.height();
+    });
+
+    // Une image triée, comme un instantané rechargé : O(n)
+    runner.run(name("load_bulkLoad_sorted", variant, n), n, [&](State &state) {
+        Tree t;
+        state.start();
+        t.bulkLoad(sorted.begin(), sorted.end());
+        state.stop();
+        return t.height();
+    });
+
+    Tree base(sorted.begin(), sorted.end());
+    const size_t height = base.height();
+
+    // L'ancienne copie, à comparer à copy de treeBenchmarks : chaque clé réinsérée
+    // dans l'ordre préfixe
+    runner.run(name("copy_insert", variant, n), n, [&](State &state) {
+        state.start();
+        Tree t;
+        base.visitPre([&](Key k) { t.insert(k); });
+        state.stop();
+        sink = sink + t.size();
+        return height;
+    });
+}
+
+/**
+ *  @brief Lots de mises à jour (insertBatch, eraseBatch, containsBatch)
+ *         comparés aux mêmes opérations une par une
+ */
+template<typename Balance>
+void batchBenchmarks(Runner &runner, const std::string &policy, const Dataset &d) {
+    using Tree = BinarySearchTree<Key, Balance>;
+    const size_t n = d.keys.size();
+    const std::string variant = policy + "/" + d.distribution;
+    const size_t batch = std::max<size_t>(n / 10, 1);
+
+    // La moitié des clés dans l'arbre, un lot de n / 10 clés de l'autre moitié
+    Tree base;
+    for (size_t i = 0; i < n; i += 2)
+        base.insert(d.keys[i]);
+    std::vector<Key> updates;
+    for (size_t i = 1; i < n and updates.size() < batch; i += 2)
+        updates.push_back(d.keys[i]);
+    const size_t height = base.height();
+
+    runner.run(name("insertBatch", variant, n), updates.size(), [&](State &state) {
+        Tree t(base);
+        state.start();
+        t.insertBatch(updates.begin(), updates.end());
+        state.stop();
+        return t.height();
+    });
+
+    runner.run(name("insertBatch_each", variant, n), updates.size(), [&](State &state) {
+        Tree t(base);
+        state.start();
+        for (Key k : updates)
+            t.insert(k);
+        state.stop();
+        return t.height();
+    });
+
+    Tree full(base);
+    full.insertBatch(updates.begin(), updates.end());
+
+    runner.run(name("eraseBatch", variant, n), updates.size(), [&](State &state) {
+        Tree t(full);
+        state.start();
+        t.eraseBatch(updates.begin(), updates.end());
+        state.stop();
+        return t.height();
+    });
+
+    runner.run(name("eraseBatch_each", variant, n), updates.size(), [&](State &state) {
+        Tree t(full);
+        state.start();
+        for (Key k : updates)
+            t.deleteElement(k);
+        state.stop();
+        return t.height();
+    });
+
+    runner.run(name("containsBatch", variant, n), updates.size(), [&](State &state) {
+        state.start();
+        std::vector<bool> found = full.containsBatch(updates.begin(), updates.end());
+        state.stop();
+        sink = sink + size_t(std::count(found.begin(), found.end(), true));
+        return height;
+    });
+
+    runner.run(name("containsBatch_each", variant, n), updates.size(), [&](State &state) {
+        size_t found = 0;
+        state.start();
+        for (Key k : updates)
+            found += full.contains(k);
+        state.stop();
+        sink = sink + found;
+        return height;
+    });
+}
+
+/**
+ *  @brief Intervalles (countRange, forEachInRange) comparés à un parcours complet
+ */
+void rangeBenchmarks(Runner &runner, const Dataset &d) {
+    AVLTree<Key> t;
+    t.bulkLoad(d.keys.begin(), d.keys.end());
+    const size_t n = d.keys.size(), height = t.height();
+    const std::vector<Key> probes = queries(runner, d);
+    const Key width = 200; // 100 clés par intervalle
+
+    runner.run(name("countRange", "avl/" + d.distribution, n), probes.size(), [&](State &state) {
+        size_t sum = 0;
+        state.start();
+        for (Key lo : probes)
+            sum += t.countRange(lo, lo + width);
+        state.stop();
+        sink = sink + sum;
+        return height;
+    });
+
+    runner.run(name("forEachInRange", "avl/" + d.distribution, n), probes.size(), [&](State &state) {
+        size_t sum = 0;
+        state.start();
+        for (Key lo : probes)
+            t.forEachInRange(lo, lo + width, [&](Key k) { sum += size_t(k); });
+        state.stop();
+        sink = sink + sum;
+        return height;
+    });
+
+    // Ce que faisaient les tableaux de bord : un parcours complet par intervalle
+    size_t scans = std::min<size_t>(probes.size(), 16);
+    runner.run(name("countRange_visitSym", "avl/" + d.distribution, n), scans, [&](State &state) {
+        size_t sum = 0;
+        state.start();
+        for (size_t i = 0; i < scans; ++i) {
+            Key lo = probes[i];
+            t.visitSym([&](Key k) { sum += k >= lo and k < lo + width; });
+        }
+        state.stop();
+        sink = sink + sum;
+        return height;
+    });
+}
+
+/**
+ *  @brief Somme des clés d'un intervalle : résumés par sous arbre (SumAugment)
+ *         comparés à un parcours symétrique complet
+ */
+void aggregateBenchmarks(Runner &runner, const Dataset &d) {
+    using SumTree = AVLTree<Key, std::allocator<Key>, NoTrace, ThreeWayLess, SumAugment<long long>>;
+    const size_t n = d.keys.size();
+    const std::vector<Key> probes = queries(runner, d);
+    const Key width = 200;                 // 100 clés par intervalle
+    const Key wide = Key(n);               // la moitié des clés
+
+    // Coût de la tenue à jour des résumés, à comparer à insert de avl
+    runner.run(name("insert", "avl+sum/" + d.distribution, n), n, [&](State &state) {
+        SumTree t;
+        state.start();
+        for (Key k : d.keys)
+            t.insert(k);
+        state.stop();
+        return t.height();
+    });
+
+    SumTree t;
+    t.bulkLoad(d.keys.begin(), d.keys.end());
+    const size_t height = t.height();
+
+    for (Key w : {width, wide}) {
+        std::string variant = "avl/" + d.distribution + (w == wide ? "/wide" : "");
+        runner.run(name("aggregate", variant, n), probes.size(), [&](State &state) {
+            long long sum = 0;
+            state.start();
+            for (Key lo : probes)
+                sum += t.aggregate(lo, lo + w);
+            state.stop();
+            sink = sink + size_t(sum);
+            return height;
+        });
+
+        size_t scans = std::min<size_t>(probes.size(), 16);
+        runner.run(name("aggregate_visitSym", variant, n), scans, [&](State &state) {
+            long long sum = 0;
+            state.start();
+            for (size_t i = 0; i < scans; ++i) {
+                Key lo = probes[i];
+                t.visitSym([&](Key k) {
+                    if (k >= lo and k < lo + w)
+                        sum += k;
+                });
+            }
+            state.stop();
+            sink = sink + size_t(sum);
+            return height;
+        });
+    }
+}
+
+/**
+ *  @brief Forme figée et image projetée comparées à l'arbre pointé
+ */
+void frozenBenchmarks(Runner &runner, const Dataset &d) {
+    AVLTree<Key> t;
+    t.bulkLoad(d.keys.begin(), d.keys.end());
+    const size_t n = d.keys.size();
+    const std::vector<Key> probes = queries(runner, d);
+
+    auto frozen = t.freeze();
+    runner.run(name("frozen_contains", d.distribution, n), probes.size(), [&](State &state) {
+        size_t found = 0;
+        state.start();
+        for (Key k : probes)
+            found += frozen.contains(k);
+        state.stop();
+        sink = sink + found;
+        return size_t(0);
+    });
+
+    runner.run(name("frozen_rank", d.distribution, n), probes.size(), [&](State &state) {
+        size_t sum = 0;
+        state.start();
+        for (Key k : probes)
+            sum += frozen.rank(k);
+        state.stop();
+        sink = sink + sum;
+        return size_t(0);
+    });
+
+    const std::string path = "bst_bench.snapshot";
+    if (runner.selected(name("snapshot_contains", d.distribution, n))) {
+        t.saveSnapshot(path);
+        {
+            auto snapshot = AVLTree<Key>::openSnapshot(path);
+            runner.run(name("snapshot_contains", d.distribution, n), probes.size(), [&](State &state) {
+                size_t found = 0;
+                state.start();
+                for (Key k : probes)
+                    found += snapshot.contains(k);
+                state.stop();
+                sink = sink + found;
+                return size_t(0);
+            });
+        }
+        std::remove(path.c_str());
+    }
+}
+
+/**
+ *  @brief B-arbre à noeuds d'une ligne de cache, comparé à BinarySearchTree<Key>
+ */
+void bTreeBenchmarks(Runner &runner, const Dataset &d) {
+    const size_t n = d.keys.size();
+    const std::vector<Key> probes = queries(runner, d);
+
+    runner.run(name("btree_insert", d.distribution, n), n, [&](State &state) {
+        BTree<Key> t;
+        state.start();
+        for (Key k : d.keys)
+            t.insert(k);
+        state.stop();
+        return t.height();
+    });
+
+    BTree<Key> base;
+    for (Key k : d.keys)
+        base.insert(k);
+
+    runner.run(name("btree_contains", d.distribution, n), probes.size(), [&](State &state) {
+        size_t found = 0;
+        state.start();
+        for (Key k : probes)
+            found += base.contains(k);
+        state.stop();
+        sink = sink + found;
+        return base.height();
+    });
+
+    runner.run(name("btree_rank", d.distribution, n), probes.size(), [&](State &state) {
+        size_t sum = 0;
+        state.start();
+        for (Key k : probes)
+            sum += base.rank(k);
+        state.stop();
+        sink = sink + sum;
+        return base.height();
+    });
+
+    runner.run(name("btree_deleteElement", d.distribution, n), d.probes.size(), [&](State &state) {
+        BTree<Key> t(base);
+        state.start();
+        for (Key k : d.probes)
+            t.deleteElement(k);
+        state.stop();
+        return base.height();
+    });
+}
+
+/**
+ *  @brief Opérations parallèles, de 1 thread à options.threads
+ */
+void parallelBenchmarks(Runner &runner, const Dataset &d) {
+    AVLTree<Key> t;
+    t.bulkLoad(d.keys.begin(), d.keys.end());
+    const size_t n = d.keys.size(), count = t.size();
+
+    for (unsigned threads = 1; threads <= runner.options().threads; threads *= 2) {
+        const std::string variant = d.distribution + "/threads:" + std::to_string(threads);
+
+        runner.run(name("balanceParallel", variant, n), count, [&](State &state) {
+            BinarySearchTree<Key> u;
+            for (Key k : d.keys)
+                u.insert(k);
+            state.start();
+            u.balanceParallel(threads);
+            state.stop();
+            return u.height();
+        });
+
+        runner.run(name("bulkLoadParallel", variant, n), n, [&](State &state) {
+            AVLTree<Key> u;
+            state.start();
+            u.bulkLoadParallel(d.keys.begin(), d.keys.end(), threads);
+            state.stop();
+            return u.height();
+        });
+
+        runner.run(name("reduce", variant, n), count, [&](State &state) {
+            state.start();
+            long sum = t.reduce(0L, [](long a, long b) { return a + b; }, threads);
+            state.stop();
+            sink = sink + size_t(sum);
+            return size_t(0);
+        });
+
+        runner.run(name("visitSymParallel", variant, n), count, [&](State &state) {
+            std::atomic<size_t> visited(0);
+            state.start();
+            t.visitSymParallel([&](Key) { visited.fetch_add(1, std::memory_order_relaxed); }, threads);
+            state.stop();
+            sink = sink + visited.load();
+            return size_t(0);
+        });
+    }
+}
+
+/**
+ *  @brief Lectures sans verrou de ConcurrentBinarySearchTree : débit total selon
+ *         le nombre de lecteurs
+ */
+void concurrentBenchmarks(Runner &runner, const Dataset &d) {
+    ConcurrentBinarySearchTree<Key> t;
+    for (Key k : d.keys)
+        t.insert(k);
+    const size_t n = d.keys.size();
+    const std::vector<Key> probes = queries(runner, d);
+
+    for (unsigned threads = 1; threads <= runner.options().threads; threads *= 2) {
+        runner.run(name("concurrent_contains", d.distribution + "/threads:" + std::to_string(threads), n),
+                   probes.size() * threads, [&](State &state) {
+                    std::atomic<size_t> found(0);
+                    std::vector<std::thread> readers;
+                    state.start();
+                    for (unsigned r = 0; r < threads; ++r)
+                        readers.emplace_back([&, r] {
+                            size_t local = 0;
+                            for (size_t i = 0; i < probes.size(); ++i)
+                                local += t.contains(probes[(i + r * 7919) % probes.size()]);
+                            found.fetch_add(local);
+                        });
+                    for (std::thread &reader : readers)
+                        reader.join();
+                    state.stop();
+                    sink = sink + found.load();
+                    return size_t(0);
+                });
+    }
+}
+
+std::vector<size_t> parseSizes(const std::string &list) {
+    std::vector<size_t> sizes;
+    size_t start = 0;
+    while (start < list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos)
+            end = list.size();
+        sizes.push_back(size_t(std::stod(list.substr(start, end - start))));
+        start = end + 1;
+    }
+    return sizes;
+}
+
+bool parse(int argc, char **argv, Options &options) {
+    size_t maxSize = size_t(-1);
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string key = arg.substr(0, eq), value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (key == "--sizes")
+            options.sizes = parseSizes(value);
+        else if (key == "--max-size")
+            maxSize = size_t(std::stod(value));
+        else if (key == "--filter")
+            options.filter = value;
+        else if (key == "--min-time")
+            options.minTime = std::stod(value);
+        else if (key == "--max-degenerate")
+            options.maxDegenerate = size_t(std::stod(value));
+        else if (key == "--threads")
+            options.threads = unsigned(std::max(1, std::stoi(value)));
+        else if (key == "--out")
+            options.out = value;
+        else
+            return false;
+    }
+    options.sizes.erase(std::remove_if(options.sizes.begin(), options.sizes.end(),
+                                       [&](size_t n) { return n == 0 or n > maxSize; }), options.sizes.end());
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    try {
+        if (!parse(argc, argv, options)) {
+            std::cerr << "usage : " << argv[0] << " [--sizes=1000,10000,...] [--max-size=N] [--filter=texte]"
+                      << " [--min-time=s] [--max-degenerate=N] [--threads=N] [--out=fichier.json]\n";
+            return EXIT_FAILURE;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "argument invalide : " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    if (std::string(Runner::buildType()) == "debug")
+        std::cerr << "***WARNING*** bst_bench compilé sans optimisation, les mesures ne sont pas représentatives\n";
+
+    Runner runner(options);
+    const char *distributions[] = {"random", "sorted", "reverse", "zipfian"};
+    for (size_t n : options.sizes) {
+        for (const char *distribution : distributions) {
+            Dataset d = makeDataset(distribution, n, unsigned(n));
+            if (!d.degenerate or n <= options.maxDegenerate) {
+                treeBenchmarks<NoBalance>(runner, "plain", d);
+                recursionBenchmarks<BinarySearchTree<Key>>(runner, "iterative", d);
+                recursionBenchmarks<RecursiveTree>(runner, "recursive", d);
+            }
+            treeBenchmarks<AVLBalance>(runner, "avl", d);
+            treeBenchmarks<ScapegoatBalance>(runner, "scapegoat", d);
+            bulkLoadBenchmarks<AVLBalance>(runner, "avl", d);
+            batchBenchmarks<AVLBalance>(runner, "avl", d);
+            rangeBenchmarks(runner, d);
+            aggregateBenchmarks(runner, d);
+            bTreeBenchmarks(runner, d);
+            if (d.distribution == "random") {
+                frozenBenchmarks(runner, d);
+                parallelBenchmarks(runner, d);
+                concurrentBenchmarks(runner, d);
+            }
+        }
+    }
+
+    if (options.out.empty()) {
+        runner.write(std::cout);
+    } else {
+        std::ofstream out(options.out);
+        runner.write(out);
+        if (!out) {
+            std::cerr << "impossible d'ecrire " << options.out << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,950 @@
+/**
+-----------------------------------------------------------------------------------
+Laboratoire : 09
+\file       bst_tests.cpp
+\author     Loïc Dessaules, Doran Kayoumi, Gabrielle Thurnherr
+\date       16/10/2026
+\brief      Tests des arbres : chaque opération est comparée à std::set,
+            std::multiset ou std::map sur des suites aléatoires reproductibles
+Compilateur MinGW-gcc 6.3.0
+
+Utilisation : bst_tests [texte]   ne lance que les tests dont le nom contient texte
+Le programme se termine avec le code 1 si une vérification échoue.
+
+Copyright (c) 2017 Olivier Cuisenaire. All rights reserved.
+**/
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <thread>
+#include <random>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+#include "BinarySearchTree.h"
+#include "BinarySearchMap.h"
+#include "BTree.h"
+#include "ConcurrentBinarySearchTree.h"
+
+// Nombre de vérifications échouées, tous tests confondus
+static size_t failures = 0;
+
+// Nombre d'allocations dynamiques du programme, tous threads confondus
+static std::atomic<size_t> allocations(0);
+
+void *operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size != 0 ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+// std::stable_sort passe par cette version pour son tampon temporaire
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size != 0 ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+    std::free(p);
+}
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            ++failures; \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": echec de " #cond << std::endl; \
+        } \
+    } while (false)
+
+#define CHECK_THROWS(expr, exception) \
+    do { \
+        bool thrown = false; \
+        try { expr; } catch (const exception &) { thrown = true; } \
+        CHECK(thrown && #exception); \
+    } while (false)
+
+// Au dessus de ParallelCutoff noeuds, les versions parallèles découpent vraiment l'arbre
+static const size_t Large = (size_t(1) << 14) * 4;
+
+/**
+ * @brief Compare les cles d'un conteneur, dans l'ordre de parcours, à celles d'un std::set
+ *        ou d'un std::multiset
+ */
+template<typename Tree, typename Reference>
+bool sameKeys(const Tree &tree, const Reference &ref) {
+    return tree.size() == ref.size() and std::equal(ref.begin(), ref.end(), tree.begin());
+}
+
+/**
+ * @brief Vérifie size, rank, nth_element et min contre la référence
+ */
+template<typename Tree>
+void checkOrderStatistics(const Tree &tree, const std::set<int> &ref) {
+    CHECK(tree.size() == ref.size());
+    size_t i = 0;
+    for (int key : ref) {
+        if (tree.rank(key) != i or tree.nth_element(i) != key) {
+            CHECK(tree.rank(key) == i);
+            CHECK(tree.nth_element(i) == key);
+            return;
+        }
+        ++i;
+    }
+    if (!ref.empty())
+        CHECK(tree.min() == *ref.begin());
+}
+
+std::vector<int> randomKeys(size_t n, int range, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<int> keys(n);
+    for (int &k : keys)
+        k = int(rng() % unsigned(range));
+    return keys;
+}
+
+//
+// Politiques d'équilibrage : insertions et suppressions aléatoires, puis hauteur
+//
+template<typename Tree>
+void randomOperations(Tree &tree, std::set<int> &ref, size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    for (size_t i = 0; i < n; ++i) {
+        int key = int(rng() % (n / 2 + 1));
+        if (rng() % 3 != 0) {
+            tree.insert(key);
+            ref.insert(key);
+        } else {
+            CHECK(tree.deleteElement(key) == (ref.erase(key) == 1));
+        }
+    }
+}
+
+void testBalancePolicies() {
+    const size_t n = 20000;
+
+    BinarySearchTree<int> plain;
+    std::set<int> ref;
+    randomOperations(plain, ref, n, 1);
+    CHECK(sameKeys(plain, ref));
+    checkOrderStatistics(plain, ref);
+    plain.balance();
+    CHECK(sameKeys(plain, ref));
+    CHECK(plain.height() <= size_t(std::ceil(std::log2(double(ref.size() + 1)))));
+
+    AVLTree<int> avl;
+    std::set<int> avlRef;
+    randomOperations(avl, avlRef, n, 2);
+    CHECK(sameKeys(avl, avlRef));
+    checkOrderStatistics(avl, avlRef);
+    CHECK(avl.height() <= size_t(1.45 * std::log2(double(avlRef.size() + 2))));
+
+    // Insertions croissantes : le pire cas sans équilibrage
+    AVLTree<int> sorted;
+    ScapegoatTree<int> scapegoat;
+    for (int i = 0; i < int(n); ++i) {
+        sorted.insert(i);
+        scapegoat.insert(i);
+    }
+    CHECK(sorted.height() <= size_t(1.45 * std::log2(double(n + 2))));
+    double bound = std::log(double(n)) / std::log(1 / scapegoat.alpha()) + 2;
+    CHECK(scapegoat.height() <= size_t(bound));
+
+    ScapegoatTree<int> sg;
+    std::set<int> sgRef;
+    randomOperations(sg, sgRef, n, 3);
+    CHECK(sameKeys(sg, sgRef));
+    checkOrderStatistics(sg, sgRef);
+    CHECK(sg.height() <= size_t(std::log(double(sgRef.size())) / std::log(1 / sg.alpha()) + 2));
+
+#ifdef BST_COUNTERS
+    // Une reconstruction par appel de balance, aucune pour linearize seul
+    BinarySearchTree<int>::resetCounters();
+    plain.balance();
+    CHECK(BinarySearchTree<int>::counters().rebuilds == 1);
+    plain.linearize();
+    CHECK(BinarySearchTree<int>::counters().rebuilds == 1);
+    plain.balance();
+    CHECK(BinarySearchTree<int>::counters().rebuilds == 2);
+#endif
+
+    CHECK_THROWS(sg.setAlpha(0.2), std::logic_error);
+    CHECK_THROWS(BinarySearchTree<int>().min(), std::logic_error);
+    CHECK_THROWS(plain.nth_element(plain.size()), std::logic_error);
+}
+
+//
+// Arbre dégénéré : les suppressions, qui ne lèvent pas d'exception, n'allouent rien
+//
+template<typename Tree>
+void degenerateRemovals() {
+    const int n = 3000;
+    Tree tree;
+    std::set<int> ref;
+    for (int i = 0; i < n; ++i) {
+        tree.insert(i);
+        ref.insert(i);
+    }
+    size_t before = allocations.load();
+    for (int i = n - 1; i >= 0; i -= 3) {
+        CHECK(tree.deleteElement(i));
+        ref.erase(i);
+    }
+    CHECK(!tree.deleteElement(-1));
+    tree.deleteMin();
+    ref.erase(ref.begin());
+    CHECK(allocations.load() == before);
+    CHECK(sameKeys(tree, ref));
+    checkOrderStatistics(tree, ref);
+
+    // Un lot qui traverse tout l'arbre : la pile de mergeBatch est réservée avant de le modifier
+    std::vector<int> erased(ref.begin(), ref.end());
+    erased.resize(erased.size() / 2);
+    CHECK(tree.eraseBatch(erased.begin(), erased.end()) == erased.size());
+    for (int key : erased)
+        ref.erase(key);
+    CHECK(sameKeys(tree, ref));
+    checkOrderStatistics(tree, ref);
+}
+
+void testDegenerate() {
+    degenerateRemovals<BinarySearchTree<int>>();
+    degenerateRemovals<BinarySearchMultiset<int>>();
+    ScapegoatTree<int> loose;
+    CHECK_THROWS(loose.setAlpha(1), std::logic_error);
+    loose.setAlpha(0.99);
+    std::set<int> ref;
+    for (int i = 0; i < 5000; ++i) {
+        loose.insert(i);
+        ref.insert(i);
+    }
+    for (int i = 0; i < 5000; i += 2) {
+        CHECK(loose.deleteElement(i));
+        ref.erase(i);
+    }
+    CHECK(sameKeys(loose, ref));
+    checkOrderStatistics(loose, ref);
+}
+
+//
+// Affectations : un arbre vide transmet aussi son comparateur, son allocateur et son équilibrage
+//
+struct Ordered {
+    bool descending;
+
+    bool operator()(int a, int b) const {
+        return descending ? b < a : a < b;
+    }
+};
+
+void testAssignment() {
+    using Tree = BinarySearchTree<int, NoBalance, std::allocator<int>, NoTrace, Ordered>;
+    const Tree descending(Ordered{true});
+
+    Tree copied(Ordered{false});
+    copied = descending;
+    copied.insert(1);
+    copied.insert(2);
+    CHECK(copied.min() == 2);
+
+    Tree moved(Ordered{false});
+    Tree source(Ordered{true});
+    moved = std::move(source);
+    moved.insert(1);
+    moved.insert(2);
+    CHECK(moved.min() == 2);
+
+    // Les noeuds d'arbres du même pool peuvent passer de l'un à l'autre
+    using Pooled = AVLTree<int, PoolAllocator<int>>;
+    PoolAllocator<int> alloc;
+    const Pooled empty(alloc);
+    Pooled shared(alloc);
+    shared.insert(1);
+    Pooled target;
+    target = empty;
+    target.insert(2);
+    target.unionWith(shared);
+    CHECK(target.size() == 2 and shared.size() == 0);
+
+    Pooled emptied(alloc);
+    Pooled stolen;
+    stolen = std::move(emptied);
+    stolen.insert(3);
+    stolen.unionWith(target);
+    CHECK(stolen.size() == 3 and target.size() == 0);
+
+    // alpha et les statistiques de reconstruction suivent l'arbre, même vide
+    ScapegoatTree<int> rebuilt;
+    rebuilt.setAlpha(0.55);
+    for (int i = 0; i < 1000; ++i)
+        rebuilt.insert(i);
+    for (int i = 0; i < 1000; ++i)
+        rebuilt.deleteElement(i);
+    const size_t rebuilds = rebuilt.rebuildStats().rebuilds;
+    CHECK(rebuilt.size() == 0 and rebuilds > 0);
+
+    ScapegoatTree<int> sgCopy;
+    sgCopy = rebuilt;
+    CHECK(sgCopy.alpha() == 0.55 and sgCopy.rebuildStats().rebuilds == rebuilds);
+    ScapegoatTree<int> sgMoved;
+    sgMoved = std::move(rebuilt);
+    CHECK(sgMoved.alpha() == 0.55 and sgMoved.rebuildStats().rebuilds == rebuilds);
+}
+
+//
+// Opérations par lots : insertBatch, eraseBatch, containsBatch
+//
+template<typename Tree>
+void batchMerge() {
+    Tree tree;
+    std::set<int> ref;
+    for (unsigned round = 0; round < 20; ++round) {
+        std::vector<int> keys = randomKeys(500 + round * 100, 5000, round);
+        CHECK(tree.insertBatch(keys.begin(), keys.end()) ==
+              size_t(std::count_if(keys.begin(), keys.end(), [&](int k) { return ref.insert(k).second; })));
+
+        std::vector<int> erased = randomKeys(300, 5000, round + 100);
+        size_t expected = 0;
+        for (int k : std::set<int>(erased.begin(), erased.end()))
+            expected += ref.erase(k);
+        CHECK(tree.eraseBatch(erased.begin(), erased.end()) == expected);
+        CHECK(sameKeys(tree, ref));
+    }
+    checkOrderStatistics(tree, ref);
+
+    std::vector<int> probes = randomKeys(1000, 6000, 77);
+    std::vector<bool> found = tree.containsBatch(probes.begin(), probes.end());
+    CHECK(found.size() == probes.size());
+    for (size_t i = 0; i < probes.size(); ++i)
+        CHECK(found[i] == (ref.count(probes[i]) == 1));
+}
+
+void testBatchMerge() {
+    batchMerge<BinarySearchTree<int>>();
+    batchMerge<AVLTree<int>>();
+    batchMerge<ScapegoatTree<int>>();
+}
+
+//
+// split, join et opérations ensemblistes
+//
+template<typename Tree>
+void splitJoin() {
+    std::vector<int> keys = randomKeys(5000, 20000, 4);
+    std::set<int> ref(keys.begin(), keys.end());
+
+    for (int cut : {-1, 0, 7000, 12345, 25000}) {
+        Tree tree;
+        tree.insertBatch(keys.begin(), keys.end());
+        auto parts = tree.split(cut);
+        CHECK(tree.size() == 0);
+        CHECK(sameKeys(parts.first, std::set<int>(ref.begin(), ref.lower_bound(cut))));
+        CHECK(sameKeys(parts.second, std::set<int>(ref.lower_bound(cut), ref.end())));
+
+        parts.first.join(parts.second);
+        CHECK(parts.second.size() == 0);
+        CHECK(sameKeys(parts.first, ref));
+        checkOrderStatistics(parts.first, ref);
+    }
+
+    Tree low, high;
+    low.insert(10);
+    high.insert(5);
+    CHECK_THROWS(low.join(high), std::logic_error);
+    CHECK(low.size() == 1 and high.size() == 1);
+
+    std::vector<int> other = randomKeys(3000, 20000, 5);
+    std::set<int> otherRef(other.begin(), other.end());
+    std::set<int> expected;
+
+    Tree a, b;
+    a.insertBatch(keys.begin(), keys.end());
+    b.insertBatch(other.begin(), other.end());
+    a.unionWith(b);
+    std::set_union(ref.begin(), ref.end(), otherRef.begin(), otherRef.end(), std::inserter(expected, expected.end()));
+    CHECK(sameKeys(a, expected));
+    CHECK(b.size() == 0);
+
+    Tree c, d;
+    c.insertBatch(keys.begin(), keys.end());
+    d.insertBatch(other.begin(), other.end());
+    c.intersectWith(d);
+    expected.clear();
+    std::set_intersection(ref.begin(), ref.end(), otherRef.begin(), otherRef.end(),
+                          std::inserter(expected, expected.end()));
+    CHECK(sameKeys(c, expected));
+    CHECK(sameKeys(d, otherRef));
+
+    // Dans l'autre sens, c'est l'arbre courant le plus petit
+    Tree f;
+    f.insertBatch(keys.begin(), keys.end());
+    d.intersectWith(f);
+    CHECK(sameKeys(d, expected));
+    checkOrderStatistics(d, expected);
+    d.insertBatch(other.begin(), other.end());
+
+    Tree e;
+    e.insertBatch(keys.begin(), keys.end());
+    e.differenceWith(d);
+    expected.clear();
+    std::set_difference(ref.begin(), ref.end(), otherRef.begin(), otherRef.end(),
+                        std::inserter(expected, expected.end()));
+    CHECK(sameKeys(e, expected));
+    checkOrderStatistics(e, expected);
+}
+
+// Deux arbres construits avec le même PoolAllocator partagent son pool
+void pooledJoin() {
+    using Tree = AVLTree<int, PoolAllocator<int>>;
+    PoolAllocator<int> alloc;
+    Tree low(alloc), high(alloc), other(alloc);
+    std::set<int> ref;
+    for (int i = 0; i < 3000; ++i) {
+        low.insert(i);
+        high.insert(i + 10000);
+        other.insert(i * 7);
+        ref.insert(i);
+        ref.insert(i + 10000);
+        ref.insert(i * 7);
+    }
+    low.join(high);
+    CHECK(high.size() == 0 and low.size() == 6000);
+    low.unionWith(other);
+    CHECK(other.size() == 0);
+    CHECK(sameKeys(low, ref));
+
+    // Les noeuds venus des autres arbres sont libérés par le pool commun
+    for (int key : ref)
+        CHECK(low.deleteElement(key));
+    CHECK(low.size() == 0);
+
+    Tree foreign;
+    foreign.insert(-1);
+    Tree mine(alloc);
+    mine.insert(1);
+    CHECK_THROWS(mine.unionWith(foreign), std::logic_error);
+    CHECK(mine.size() == 1 and foreign.size() == 1);
+}
+
+void testSplitJoin() {
+    splitJoin<BinarySearchTree<int>>();
+    splitJoin<AVLTree<int>>();
+    splitJoin<ScapegoatTree<int>>();
+    pooledJoin();
+}
+
+//
+// Forme figée : freeze
+//
+void testFreeze() {
+    std::vector<int> keys = randomKeys(10000, 50000, 6);
+    std::set<int> ref(keys.begin(), keys.end());
+    AVLTree<int> tree;
+    tree.insertBatch(keys.begin(), keys.end());
+
+    auto frozen = tree.freeze();
+    CHECK(frozen.size() == ref.size());
+    CHECK(std::equal(ref.begin(), ref.end(), frozen.begin()));
+    for (int key = -1; key < 50001; key += 7) {
+        CHECK(frozen.contains(key) == (ref.count(key) == 1));
+        CHECK(frozen.countLess(key) == size_t(std::distance(ref.begin(), ref.lower_bound(key))));
+    }
+    for (size_t i = 0; i < frozen.size(); i += 97)
+        CHECK(frozen.rank(frozen.nth_element(i)) == i);
+    CHECK(frozen.countRange(100, 20000) == tree.countRange(100, 20000));
+
+    // Le foncteur est passé par référence : son état est visible après l'appel
+    struct Collect {
+        std::vector<int> keys;
+        void operator()(int key) { keys.push_back(key); }
+    } inTree, inFrozen;
+    tree.forEachInRange(100, 20000, inTree);
+    frozen.forEachInRange(100, 20000, inFrozen);
+    CHECK(inTree.keys.size() == tree.countRange(100, 20000) and inTree.keys == inFrozen.keys);
+}
+
+//
+// Image projetée : saveSnapshot puis openSnapshot, et rejet des images abîmées
+//
+std::string readFile(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string &path, const std::string &content) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(content.data(), std::streamsize(content.size()));
+}
+
+// Remplace le champ de type uint64_t situé à offset dans l'en-tête
+void patch(std::string &image, size_t offset, uint64_t value) {
+    std::memcpy(&image[offset], &value, sizeof value);
+}
+
+void testSnapshot() {
+    const std::string path = "bst_tests_snapshot.bin";
+    std::vector<int> keys = randomKeys(10000, 50000, 15);
+    std::set<int> ref(keys.begin(), keys.end());
+    AVLTree<int> tree;
+    tree.insertBatch(keys.begin(), keys.end());
+    tree.saveSnapshot(path);
+
+    {
+        auto snapshot = AVLTree<int>::openSnapshot(path);
+        CHECK(snapshot.size() == ref.size());
+        CHECK(std::equal(ref.begin(), ref.end(), snapshot.begin()));
+        for (int key = -1; key < 50001; key += 7) {
+            CHECK(snapshot.contains(key) == (ref.count(key) == 1));
+            if (ref.count(key) == 1)
+                CHECK(snapshot.rank(key) == tree.rank(key));
+        }
+        for (size_t i = 0; i < snapshot.size(); i += 89)
+            CHECK(snapshot.nth_element(i) == tree.nth_element(i));
+    }
+
+    const std::string image = readFile(path);
+    const uint64_t huge = ~uint64_t(0);
+    std::vector<std::string> damaged;
+    damaged.push_back(image.substr(0, sizeof(SnapshotHeader) / 2));
+    damaged.push_back(image.substr(0, image.size() - 1));
+    damaged.push_back(image);
+    damaged.back()[0] ^= 0x5a;
+    damaged.push_back(image);
+    patch(damaged.back(), offsetof(SnapshotHeader, count), huge / sizeof(int) + 2);
+    // Décalages proches de 2^64 : leurs sommes débordent et reviennent sous la taille du fichier
+    damaged.push_back(image);
+    patch(damaged.back(), offsetof(SnapshotHeader, sortedOffset), huge - 191);
+    patch(damaged.back(), offsetof(SnapshotHeader, eytzingerOffset), huge - 127);
+    patch(damaged.back(), offsetof(SnapshotHeader, rankOffset), huge - 63);
+    damaged.push_back(image);
+    patch(damaged.back(), offsetof(SnapshotHeader, rankOffset), 64);
+    // Un rang égal au nombre de clés ferait lire après la dernière clé triée
+    SnapshotHeader header;
+    std::memcpy(&header, image.data(), sizeof header);
+    damaged.push_back(image);
+    patch(damaged.back(), size_t(header.rankOffset + (header.count - 1) * sizeof(uint64_t)), header.count);
+
+    for (const std::string &bad : damaged) {
+        writeFile(path, bad);
+        CHECK_THROWS(AVLTree<int>::openSnapshot(path), std::runtime_error);
+    }
+    writeFile(path, image);
+    CHECK_THROWS(BinarySearchTree<long long>::openSnapshot(path), std::runtime_error);
+    std::remove(path.c_str());
+    CHECK_THROWS(AVLTree<int>::openSnapshot(path), std::runtime_error);
+}
+
+//
+// Flux binaire : aller-retour, puis détection des corruptions
+//
+void testStream() {
+    std::mt19937 rng(7);
+    BinarySearchTree<std::string> tree;
+    for (int i = 0; i < 20000; ++i)
+        tree.insert(std::string(rng() % 30, char('a' + rng() % 26)) + std::to_string(i));
+
+    std::stringstream out(std::ios::in | std::ios::out | std::ios::binary);
+    tree.save(out);
+    const std::string image = out.str();
+
+    AVLTree<std::string> loaded;
+    std::stringstream in(image);
+    loaded.load(in);
+    CHECK(loaded.size() == tree.size());
+    CHECK(std::equal(tree.begin(), tree.end(), loaded.begin()));
+    CHECK(loaded.height() <= size_t(std::ceil(std::log2(double(tree.size() + 1)))));
+
+    for (size_t pos : {size_t(3), size_t(40), image.size() / 2, image.size() - 1}) {
+        std::string bad = image;
+        bad[pos] ^= 0x5a;
+        std::stringstream corrupted(bad);
+        BinarySearchTree<std::string> target;
+        target.insert("garde");
+        CHECK_THROWS(target.load(corrupted), std::runtime_error);
+        CHECK(target.size() == 1 and target.contains("garde"));
+    }
+
+    std::stringstream truncated(image.substr(0, image.size() / 3));
+    CHECK_THROWS(loaded.load(truncated), std::runtime_error);
+    CHECK(loaded.size() == tree.size());
+
+    std::stringstream wrongType(image);
+    BinarySearchTree<long> numbers;
+    CHECK_THROWS(numbers.load(wrongType), std::runtime_error);
+
+    // Un nombre de clés corrompu est refusé par l'en-tête, avant qu'aucun noeud ne soit créé
+    using Traced = BinarySearchTree<int, NoBalance, std::allocator<int>, RingBufferTrace<int>>;
+    Traced traced;
+    for (int i = 0; i < 1000; ++i)
+        traced.insert(i);
+    std::stringstream tracedOut(std::ios::in | std::ios::out | std::ios::binary);
+    traced.save(tracedOut);
+    std::string badCount = tracedOut.str();
+    badCount[offsetof(StreamHeader, count)] ^= 0x01;
+    std::stringstream countStream(badCount);
+    size_t events = RingBufferTrace<int>::total();
+    CHECK_THROWS(traced.load(countStream), std::runtime_error);
+    CHECK(RingBufferTrace<int>::total() == events and traced.size() == 1000);
+
+    // Un bloc annoncé plus grand que StreamMaxChunkBytes est refusé sans être lu
+    std::string oversized = image.substr(0, sizeof(StreamHeader));
+    StreamChunkHeader chunk = {1, uint32_t(StreamMaxChunkBytes + 1), 0};
+    oversized.append(reinterpret_cast<const char *>(&chunk), sizeof chunk);
+    oversized.append(StreamMaxChunkBytes + 1, 'x');
+    std::stringstream oversizedStream(oversized);
+    CHECK_THROWS(loaded.load(oversizedStream), std::runtime_error);
+    CHECK(loaded.size() == tree.size());
+
+    BinarySearchTree<std::string> huge;
+    huge.insert(std::string(StreamMaxChunkBytes, 'k'));
+    std::stringstream hugeStream(std::ios::in | std::ios::out | std::ios::binary);
+    CHECK_THROWS(huge.save(hugeStream), std::runtime_error);
+}
+
+//
+// BTree contre std::set
+//
+template<typename T>
+void btreeAgainstSet(unsigned seed) {
+    std::mt19937 rng(seed);
+    BTree<T> tree;
+    std::set<T> ref;
+    for (size_t i = 0; i < 60000; ++i) {
+        T key = T(rng() % 20000);
+        if (rng() % 5 < 3)
+            CHECK(tree.insert(key) == ref.insert(key).second);
+        else
+            CHECK(tree.deleteElement(key) == (ref.erase(key) == 1));
+    }
+    CHECK(tree.size() == ref.size());
+
+    std::vector<T> visited;
+    tree.visitSym([&](T key) { visited.push_back(key); });
+    CHECK(std::equal(ref.begin(), ref.end(), visited.begin()) and visited.size() == ref.size());
+
+    size_t i = 0;
+    for (T key : ref) {
+        if (tree.rank(key) != i or tree.nth_element(i) != key) {
+            CHECK(tree.rank(key) == i);
+            CHECK(tree.nth_element(i) == key);
+            break;
+        }
+        ++i;
+    }
+    CHECK(tree.rank(T(30000)) == size_t(-1));
+    CHECK(tree.min() == *ref.begin());
+
+    BTree<T> copy(tree);
+    for (T key : ref)
+        copy.deleteElement(key);
+    CHECK(copy.size() == 0 and tree.size() == ref.size());
+    CHECK_THROWS(copy.min(), std::logic_error);
+}
+
+void testBTree() {
+    btreeAgainstSet<int>(8);
+    btreeAgainstSet<unsigned>(9);
+    btreeAgainstSet<long long>(10);
+    btreeAgainstSet<double>(11);
+
+    // La destruction n'alloue pas, même sur plusieurs niveaux
+    BTree<int> *tree = new BTree<int>();
+    for (int key : randomKeys(50000, 1 << 20, 12))
+        tree->insert(key);
+    size_t before = allocations.load();
+    delete tree;
+    CHECK(allocations.load() == before);
+}
+
+//
+// Multiensemble contre std::multiset
+//
+void testMultiset() {
+    std::mt19937 rng(12);
+    BinarySearchMultiset<int, AVLBalance> tree;
+    std::multiset<int> ref;
+    for (size_t i = 0; i < 30000; ++i) {
+        int key = int(rng() % 2000);
+        if (rng() % 3 != 0) {
+            tree.insert(key);
+            ref.insert(key);
+        } else {
+            auto it = ref.find(key);
+            CHECK(tree.deleteElement(key) == (it != ref.end()));
+            if (it != ref.end())
+                ref.erase(it);
+        }
+    }
+    CHECK(tree.size() == ref.size());
+    for (int key = -1; key <= 2000; key += 13)
+        CHECK(tree.count(key) == ref.count(key));
+    CHECK(tree.countRange(100, 900) == size_t(std::distance(ref.lower_bound(100), ref.lower_bound(900))));
+    for (size_t i = 0; i < ref.size(); i += 101)
+        CHECK(tree.nth_element(i) == *std::next(ref.begin(), long(i)));
+
+    // Comme std::multiset, parcours et itérateurs présentent count(key) fois chaque cle
+    CHECK(size_t(std::distance(tree.begin(), tree.end())) == tree.size());
+    CHECK(std::equal(ref.begin(), ref.end(), tree.begin()));
+    CHECK(std::equal(ref.rbegin(), ref.rend(), tree.rbegin()));
+    std::vector<int> visited;
+    tree.visitSym([&](int key) { visited.push_back(key); });
+    CHECK(visited.size() == ref.size() and std::equal(ref.begin(), ref.end(), visited.begin()));
+    size_t inRange = 0;
+    tree.forEachInRange(100, 900, [&](int) { ++inRange; });
+    CHECK(inRange == tree.countRange(100, 900));
+
+    // La forme figée garde chaque occurrence
+    auto frozen = tree.freeze();
+    CHECK(frozen.size() == tree.size());
+    for (size_t i = 0; i < ref.size(); i += 101)
+        CHECK(frozen.nth_element(i) == tree.nth_element(i));
+    for (int key = -1; key <= 2000; key += 13) {
+        CHECK(frozen.rank(key) == tree.rank(key));
+        CHECK(size_t(frozen.upper_bound(key) - frozen.lower_bound(key)) == tree.count(key));
+    }
+
+    // reduce, réparti entre plusieurs threads, voit les mêmes occurrences qu'aggregate
+    BinarySearchMultiset<int, AVLBalance, std::allocator<int>, NoTrace, ThreeWayLess, SumAugment<long long>> summed;
+    for (size_t i = 0; i < Large; ++i)
+        summed.insert(int(rng() % 5000));
+    long long total = summed.reduce(0LL, [](long long acc, long long key) { return acc + key; }, 4);
+    CHECK(total == summed.aggregate());
+    std::atomic<size_t> seen(0);
+    summed.visitSymParallel([&](int) { seen.fetch_add(1, std::memory_order_relaxed); }, 4);
+    CHECK(seen.load() == summed.size());
+
+    // Intersection dans les deux sens : chaque cle garde le minimum des occurrences
+    BinarySearchMultiset<int, AVLBalance> few, many(tree);
+    std::multiset<int> fewRef;
+    for (int i = 0; i < 500; ++i) {
+        int key = int(rng() % 2000);
+        few.insert(key);
+        fewRef.insert(key);
+    }
+    std::multiset<int> common;
+    std::set_intersection(ref.begin(), ref.end(), fewRef.begin(), fewRef.end(), std::inserter(common, common.end()));
+    BinarySearchMultiset<int, AVLBalance> fewCopy(few);
+    many.intersectWith(few);
+    fewCopy.intersectWith(tree);
+    CHECK(many.size() == common.size() and fewCopy.size() == common.size());
+    for (int key = 0; key < 2000; ++key)
+        CHECK(many.count(key) == common.count(key) and fewCopy.count(key) == common.count(key));
+
+    std::stringstream out(std::ios::in | std::ios::out | std::ios::binary);
+    tree.save(out);
+    BinarySearchMultiset<int> loaded;
+    loaded.load(out);
+    CHECK(loaded.size() == ref.size());
+    for (int key = 0; key < 2000; key += 17)
+        CHECK(loaded.count(key) == ref.count(key));
+}
+
+//
+// Dictionnaire contre std::map
+//
+template<typename Map>
+void mapAgainstStd() {
+    std::mt19937 rng(13);
+    Map map;
+    std::map<std::string, int> ref;
+    for (int i = 0; i < 30000; ++i) {
+        std::string key = "cle" + std::to_string(rng() % 2000);
+        switch (rng() % 4) {
+            case 0:
+                map[key] += 1;
+                ref[key] += 1;
+                break;
+            case 1:
+                CHECK(map.erase(key) == (ref.erase(key) == 1));
+                break;
+            case 2:
+                map.insertOrAssign(key, i);
+                ref[key] = i;
+                break;
+            default: {
+                auto it = ref.find(key);
+                CHECK(map.contains(key) == (it != ref.end()));
+                if (it != ref.end())
+                    CHECK(map.at(key) == it->second);
+                else
+                    CHECK_THROWS(map.at(key), std::logic_error);
+            }
+        }
+    }
+    CHECK(map.size() == ref.size());
+    if (!ref.empty()) {
+        const std::string &first = ref.begin()->first;
+        map.at(first) = -1;
+        const Map &constMap = map;
+        CHECK(constMap.at(first) == -1);
+        ref[first] = -1;
+    }
+    auto expected = ref.begin();
+    for (const auto &entry : map) {
+        CHECK(entry.first == expected->first and entry.second == expected->second);
+        ++expected;
+    }
+}
+
+void testMap() {
+    mapAgainstStd<BinarySearchMap<std::string, int>>();
+    mapAgainstStd<BinarySearchMap<std::string, int, AVLBalance>>();
+    mapAgainstStd<BinarySearchMap<std::string, int, ScapegoatBalance>>();
+}
+
+//
+// Versions parallèles, au dessus de ParallelCutoff
+//
+void testParallel() {
+    std::vector<int> keys = randomKeys(Large, int(Large * 4), 14);
+    std::set<int> ref(keys.begin(), keys.end());
+    const unsigned threads = 4;
+
+    BinarySearchTree<int> tree;
+    tree.bulkLoadParallel(keys.begin(), keys.end(), threads);
+    CHECK(sameKeys(tree, ref));
+    CHECK(tree.height() <= size_t(std::ceil(std::log2(double(ref.size() + 1)))));
+
+    // Insertions dans l'ordre aléatoire : l'arbre est déséquilibré sans être dégénéré
+    BinarySearchTree<int> unbalanced;
+    for (int key : keys)
+        unbalanced.insert(key);
+    unbalanced.balanceParallel(threads);
+    CHECK(sameKeys(unbalanced, ref));
+    CHECK(unbalanced.height() == tree.height());
+    checkOrderStatistics(unbalanced, ref);
+
+    long long expected = 0;
+    for (int key : ref)
+        expected += key;
+    CHECK(tree.reduce(0LL, [](long long a, long long b) { return a + b; }, threads) == expected);
+    CHECK(tree.mapReduce(size_t(0), [](size_t acc, int) { return acc + 1; },
+                         [](size_t a, size_t b) { return a + b; }, threads) == ref.size());
+
+    std::vector<int> visited(ref.size());
+    size_t next = 0;
+    tree.visitSym([&](int key) { visited[next++] = key; });
+    std::vector<char> seen(ref.size(), 0);
+    tree.visitSymParallel([&](int key) { seen[tree.rank(key)] = 1; }, threads);
+    CHECK(std::count(seen.begin(), seen.end(), 1) == long(ref.size()));
+    CHECK(std::equal(ref.begin(), ref.end(), visited.begin()));
+}
+
+//
+// Arbre concurrent : écrivains et lecteurs simultanés, puis comparaison
+//
+void testConcurrent() {
+    ConcurrentBinarySearchTree<int> tree;
+    const int perThread = 5000;
+    const unsigned writers = 4;
+
+    std::vector<std::thread> threads;
+    for (unsigned w = 0; w < writers; ++w)
+        threads.emplace_back([&tree, w] {
+            // Chaque écrivain insère ses multiples de writers, puis supprime les pairs
+            for (int i = 0; i < perThread; ++i)
+                tree.insert(i * int(writers) + int(w));
+            for (int i = 0; i < perThread; i += 2)
+                tree.deleteElement(i * int(writers) + int(w));
+        });
+    bool consistent = true;
+    threads.emplace_back([&tree, &consistent] {
+        for (int i = 0; i < 2000; ++i) {
+            size_t n = tree.size();
+            if (n > 0 and tree.rank(tree.nth_element(0)) != 0)
+                consistent = false;
+        }
+    });
+    for (std::thread &t : threads)
+        t.join();
+    CHECK(consistent);
+
+    std::set<int> ref;
+    for (unsigned w = 0; w < writers; ++w)
+        for (int i = 1; i < perThread; i += 2)
+            ref.insert(i * int(writers) + int(w));
+    checkOrderStatistics(tree, ref);
+    for (int key = 0; key < perThread * int(writers); key += 3)
+        CHECK(tree.contains(key) == (ref.count(key) == 1));
+
+    // Plus de lecteurs que d'emplacements : les suivants passent par l'emplacement verrouillé
+    ConcurrentBinarySearchTree<int, 2> few;
+    std::atomic<bool> stop(false);
+    std::atomic<size_t> reads(0);
+    std::vector<std::thread> readers;
+    for (unsigned r = 0; r < 8; ++r)
+        readers.emplace_back([&few, &stop, &reads] {
+            while (!stop.load()) {
+                few.contains(1);
+                reads.fetch_add(1);
+            }
+        });
+    for (int i = 0; i < 2000; ++i)
+        few.insert(i);
+    stop.store(true);
+    for (std::thread &t : readers)
+        t.join();
+    CHECK(few.size() == 2000 and few.rank(1999) == 1999 and reads.load() > 0);
+}
+
+int main(int argc, char *argv[]) {
+    const std::pair<const char *, std::function<void()>> tests[] = {
+            {"balance",    testBalancePolicies},
+            {"degenerate", testDegenerate},
+            {"assign",     testAssignment},
+            {"batch",      testBatchMerge},
+            {"split",      testSplitJoin},
+            {"freeze",     testFreeze},
+            {"snapshot",   testSnapshot},
+            {"stream",     testStream},
+            {"btree",      testBTree},
+            {"multiset",   testMultiset},
+            {"map",        testMap},
+            {"parallel",   testParallel},
+            {"concurrent", testConcurrent},
+    };
+
+    const std::string filter = argc > 1 ? argv[1] : "";
+    for (const auto &test : tests) {
+        if (std::string(test.first).find(filter) == std::string::npos)
+            continue;
+        size_t before = failures;
+        test.second();
+        std::cout << (failures == before ? "ok     " : "ECHEC  ") << test.first << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}